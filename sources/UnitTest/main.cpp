@@ -28,20 +28,35 @@ int main(int argc, char **argv)
     // Alg utests
     {
         using namespace Alg;
-        RUN_TEST(Alg::uTestUF<PlainUF>);
-        RUN_TEST(Alg::uTestUF<TreeUF<>>);
+        ALG_RUN_TEST(Alg::uTestUF<PlainUF>);
+        ALG_RUN_TEST(Alg::uTestUF<TreeUF<>>);
 
         //Typedefs needed to avoid comma in RUN_TEST macro calls
         typedef TreeUF<NotWeighted, PathCompression> NotWeightedPathCompressionTree;
         typedef TreeUF<Weighted, NoCompression> WeightedNoCompressionTree;
         
-        RUN_TEST(Alg::uTestUF<NotWeightedPathCompressionTree>);
-        RUN_TEST(Alg::uTestUF<WeightedNoCompressionTree>);
+        ALG_RUN_TEST(Alg::uTestUF<NotWeightedPathCompressionTree>);
+        ALG_RUN_TEST(Alg::uTestUF<WeightedNoCompressionTree>);
 
-        RUN_TEST(Alg::uTestBinSearch);
-        RUN_TEST(Alg::uTestTrivialSorts);
-        RUN_TEST(Alg::uTestSort);
-        RUN_TEST(Alg::uTestHeap);
+        ALG_RUN_TEST(Alg::uTestBinSearch);
+        ALG_RUN_TEST(Alg::uTestSearchIndex);
+        ALG_RUN_TEST(Alg::uTestInterpolationSearch);
+        ALG_RUN_TEST(Alg::uTestTrivialSorts);
+        ALG_RUN_TEST(Alg::uTestStaticSort);
+        ALG_RUN_TEST(Alg::uTestSort);
+        ALG_RUN_TEST(Alg::uTestSortBy);
+        ALG_RUN_TEST(Alg::uTestSortDispatch);
+        ALG_RUN_TEST(Alg::uTestIncrementalSort);
+        ALG_RUN_TEST(Alg::uTestStringSort);
+        ALG_RUN_TEST(Alg::uTestSetOps);
+        ALG_RUN_TEST(Alg::uTestShuffle);
+        ALG_RUN_TEST(Alg::uTestHeap);
+        ALG_RUN_TEST(Alg::uTestExternalQueue);
+        ALG_RUN_TEST(Alg::uTestWorkspace);
+        ALG_RUN_TEST(Alg::uTestLargeStorage);
+        ALG_RUN_TEST(Alg::uTestExecution);
+        ALG_RUN_TEST(Alg::uTestInstrument);
+        ALG_RUN_TEST(Alg::uTestGraph);
     }
     
     Utils::Log::deinit();
@@ -29,6 +29,33 @@
 #    define UTILS_ASSERTD(cond) ASSERT_XD(cond, "Algorithms", "")
 #endif
 
+/**
+* Software prefetch of the cache line with the given address (a hint, may be a no-op)
+* @ingroup Algorithms
+*/
+#if !defined(ALG_PREFETCH)
+#    if defined(__GNUC__) || defined(__clang__)
+#        define ALG_PREFETCH(addr) __builtin_prefetch(addr)
+#    elif defined(_MSC_VER)
+#        include <xmmintrin.h>
+#        define ALG_PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#    else
+#        define ALG_PREFETCH(addr)
+#    endif
+#endif
+
+/**
+* constexpr for the functions that need the relaxed C++14 rules (loops, assignments), nothing before C++14
+* @ingroup Algorithms
+*/
+#if !defined(ALG_CONSTEXPR14)
+#    if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#        define ALG_CONSTEXPR14 constexpr
+#    else
+#        define ALG_CONSTEXPR14
+#    endif
+#endif
+
 namespace Alg
 {
     using namespace Utils;
@@ -36,9 +63,25 @@ namespace Alg
     template <class UFImpl> bool uTestUF(UnitTest *utest_p);
 }
 
+#include "execution.h"    // Execution policies and the shared thread pool
+#include "large_storage.h" // Huge pages and NUMA placement of big arrays
 #include "uf.h"           // Union-find algorithms
 #include "bin_search.h"   // Binary search algorithm
+#include "search_index.h" // Static search index with cache-friendly layout
+#include "interpolation_search.h" // Interpolation search and learned index
+#include "workspace.h"    // Reusable scratch memory and arena allocator
 #include "sort_trivial.h" // Trivial sorting algorithms
+#include "static_sort.h"  // Sorting networks for sizes known at compile time
 #include "heap.h"         // Heap related algorithms and the PriorityQueue class
+#include "external_queue.h" // Priority queue that spills sorted runs to files
 #include "sort.h"         // Non-trivial sorting algorothms
+#include "sort_by.h"      // Sorting by projected keys
+#include "sort_dispatch.h" // Sorting front end that picks the algorithm
+#include "incremental_sort.h" // Sorting of the smallest elements on demand
+#include "string_sort.h"  // String sorting algorithms
+#include "set_ops.h"      // Intersection, union and difference of sorted sets
+#include "random.h"       // Pseudo-random number generator
+#include "shuffle.h"      // Shuffling and sampling
+#include "instrument.h"   // Operation counting and hardware performance counters
+#include "graph.h"        // CSR graph, spanning trees, shortest paths and BFS
 
@@ -87,9 +87,157 @@ bool Alg::uTestBinSearch(UnitTest *utest_p)
 
     }
 
+    // Test bounds and search of values outside of the range, with duplicates, in short sequences
+    for (UInt32 size = 0; size < 40; size++)
+    {
+        std::vector<UInt32> vec;
+        for (UInt32 i = 0; i < size; i++) vec.push_back(2 * (i / 3) + 1); // Triples of odd numbers
+
+        for (UInt32 val = 0; val <= 2 * size / 3 + 2; val++)
+        {
+            auto lower = std::lower_bound(vec.begin(), vec.end(), val);
+            auto upper = std::upper_bound(vec.begin(), vec.end(), val);
+
+            UTEST_CHECK(utest_p, lowerBound(val, vec.begin(), vec.end()) == lower);
+            UTEST_CHECK(utest_p, upperBound(val, vec.begin(), vec.end()) == upper);
+            UTEST_CHECK(utest_p, binSearch(val, vec) == (lower != upper ? lower : vec.end()));
+        }
+    }
+
+    // Test batched search, long enough batches use the vector path if it is enabled
+    {
+        std::vector<UInt32> vec;
+        for (UInt32 i = 0; i < 1000; i++) vec.push_back(3 * i + (i % 7 == 0 ? 1 : 0));
+
+        std::vector<UInt32> queries;
+        for (UInt32 i = 0; i < 3100; i++) queries.push_back( (i * 2654435761u) % 3010);
+
+        std::vector<size_t> results;
+        lowerBoundBatch(queries, vec, results);
+        UTEST_CHECK(utest_p, results.size() == queries.size());
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            UTEST_CHECK(utest_p, results[i] == size_t(std::lower_bound(vec.begin(), vec.end(), queries[i]) - vec.begin()));
+        }
+
+        binSearchBatch(queries, vec, results);
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            auto pos = binSearch(queries[i], vec);
+            UTEST_CHECK(utest_p, results[i] == size_t(pos - vec.begin()));
+        }
+
+        // Descending order and an empty sequence
+        std::vector<UInt32> rvec(vec.rbegin(), vec.rend());
+        lowerBoundBatch(queries, rvec, results, std::greater<UInt32>());
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            UTEST_CHECK(utest_p, results[i] == size_t(std::lower_bound(rvec.begin(), rvec.end(), queries[i], 
+                                                                       std::greater<UInt32>()) - rvec.begin()));
+        }
+
+        std::vector<UInt32> empty;
+        binSearchBatch(queries, empty, results);
+        UTEST_CHECK(utest_p, results.size() == queries.size() && results.back() == 0);
+    }
+
+    return utest_p->result();
+}
+
+
+/**
+ * Unit test for the static search index
+ */
+bool Alg::uTestSearchIndex(UnitTest *utest_p)
+{
+    // Compare every lookup with the standard library for all tree shapes up to 70 elements
+    for (UInt32 size = 0; size < 70; size++)
+    {
+        std::vector<UInt32> data;
+        for (UInt32 i = 0; i < size; i++) data.push_back(2 * (i / 3)); // Triples of even numbers
+
+        StaticSearchIndex<UInt32> index(data.begin(), data.end());
+        UTEST_CHECK(utest_p, index.size() == size);
+
+        for (UInt32 val = 0; val <= 2 * size / 3 + 2; val++)
+        {
+            size_t lower = std::lower_bound(data.begin(), data.end(), val) - data.begin();
+            size_t upper = std::upper_bound(data.begin(), data.end(), val) - data.begin();
+
+            UTEST_CHECK(utest_p, index.lowerBound(val) == lower);
+            UTEST_CHECK(utest_p, index.upperBound(val) == upper);
+            UTEST_CHECK(utest_p, index.find(val) == (lower != upper ? lower : size));
+        }
+    }
+
+    // Custom comparison
+    {
+        std::vector<A> data = { { 1, 1 }, { 2, 2 }, { 3, 3 }, { 4, 5 }, { 6, 5 }, { 5, 6 } };
+        A item1 = { 0, 5 };
+        A item2 = { 0, 4 };
+
+        StaticSearchIndex<A, bool (*)(const A&, const A&)> index(data.begin(), data.end(), mycomp);
+
+        UTEST_CHECK(utest_p, index.lowerBound(item1) == 3);
+        UTEST_CHECK(utest_p, index.upperBound(item1) == 5);
+        UTEST_CHECK(utest_p, data[index.find(item1)].b == 5);
+        UTEST_CHECK(utest_p, index.find(item2) == data.size());
+    }
+
     return utest_p->result();
 }
 
+/**
+ * Unit test for interpolation search and learned index
+ */
+bool Alg::uTestInterpolationSearch(UnitTest *utest_p)
+{
+    // Uniform keys, keys with quadratic growth and long runs of duplicates
+    for (int shape = 0; shape < 3; shape++)
+    {
+        for (UInt32 size : { 0, 1, 2, 3, 10, 100, 5000 })
+        {
+            std::vector<UInt64> keys;
+            for (UInt64 i = 0; i < size; i++)
+            {
+                switch (shape)
+                {
+                case 0: keys.push_back(10 * i + (i * 7) % 10); break;
+                case 1: keys.push_back(i * i); break;
+                default: keys.push_back( (i / 500) * 1000 + (i % 500 >= 497 ? i % 500 : 0)); break;
+                }
+            }
+
+            LearnedIndex<UInt64> index(keys, 4);
+            UTEST_CHECK(utest_p, size == 0 || index.numSegments() >= 1);
+
+            UInt64 max_key = keys.empty() ? 10 : keys.back() + 10;
+            for (UInt64 val = 0; val <= max_key; val += 1 + max_key / 2000)
+            {
+                auto lower = std::lower_bound(keys.begin(), keys.end(), val);
+                auto found = (lower != keys.end() && *lower == val) ? lower : keys.end();
+
+                UTEST_CHECK(utest_p, interpolationLowerBound(val, keys.begin(), keys.end()) == lower);
+                UTEST_CHECK(utest_p, interpolationSearch(val, keys) == found);
+                UTEST_CHECK(utest_p, index.lowerBound(val) == lower);
+                UTEST_CHECK(utest_p, index.find(val) == found);
+            }
+        }
+    }
+
+    // Uniform keys need one segment
+    {
+        std::vector<UInt32> keys;
+        for (UInt32 i = 0; i < 10000; i++) keys.push_back(3 * i);
+
+        LearnedIndex<UInt32> index(keys);
+        UTEST_CHECK(utest_p, index.numSegments() == 1);
+        UTEST_CHECK(utest_p, *index.find(2997) == 2997);
+        UTEST_CHECK(utest_p, index.find(2998) == keys.end());
+    }
+
+    return utest_p->result();
+}
 
 bool Alg::uTestTrivialSorts(UnitTest *utest_p)
 {
@@ -126,6 +274,127 @@ bool Alg::uTestTrivialSorts(UnitTest *utest_p)
     return utest_p->result();
 }
 
+/**
+ * Check of the sorting network of N elements by the 0-1 principle: a network that sorts all 2^N sequences
+ * of zeros and ones sorts everything. Also counts the comparators of the networks from N down to 1
+ */
+template <size_t N> struct StaticSortCheck
+{
+    static bool zeroOne()
+    {
+        for (UInt32 bits = 0; bits < (1u << N); bits++)
+        {
+            std::array<UInt8, N> arr;
+            for (size_t i = 0; i < N; i++) arr[i] = (bits >> i) & 1;
+            staticSort(arr);
+            if ( !std::is_sorted(arr.begin(), arr.end())) return false;
+        }
+        return StaticSortCheck<N - 1>::zeroOne();
+    }
+
+    static void sizes(std::vector<UInt64> &comparators)
+    {
+        std::array<UInt32, N> arr = {};
+        Instrument::opCounts().reset();
+        staticSort(arr, Instrument::countingCompare( std::less<UInt32>()));
+        comparators[N] = Instrument::opCounts().compares;
+        StaticSortCheck<N - 1>::sizes(comparators);
+    }
+};
+
+template <> struct StaticSortCheck<0>
+{
+    static bool zeroOne() { return true; }
+    static void sizes(std::vector<UInt64> &comparators) { comparators[0] = 0; }
+};
+
+#if __cplusplus >= 201402L
+/** Sorting at compile time */
+constexpr std::array<Int32, 6> constSorted()
+{
+    std::array<Int32, 6> arr = {{ 4, -1, 7, 3, 3, 0 }};
+    staticSort(arr);
+    return arr;
+}
+constexpr std::array<Int32, 6> const_sorted = constSorted();
+static_assert( std::get<0>(const_sorted) == -1 && std::get<2>(const_sorted) == 3 && std::get<5>(const_sorted) == 7,
+               "staticSort is not constexpr");
+#endif
+
+bool Alg::uTestStaticSort(UnitTest *utest_p)
+{
+    // Networks sort all the 0-1 inputs, the small ones have the optimal number of comparators
+    {
+        UTEST_CHECK(utest_p, StaticSortCheck<16>::zeroOne());
+
+        std::vector<UInt64> comparators(33);
+        StaticSortCheck<32>::sizes(comparators);
+        const UInt64 optimal[] = { 0, 0, 1, 3, 5, 9, 12, 16, 19 };
+        UTEST_CHECK(utest_p, std::equal(optimal, optimal + 9, comparators.begin()));
+        UTEST_CHECK(utest_p, comparators[16] == 63);
+    }
+
+    // Random inputs of the bigger sizes, values that are not trivially copyable and custom orders
+    {
+        Xoshiro256 rng(11);
+        bool sorted = true;
+        for (int t = 0; t < 100; t++)
+        {
+            std::array<UInt32, 32> arr;
+            for (UInt32 &val : arr) val = static_cast<UInt32>( rng.bounded(50));
+            staticSort(arr);
+            sorted = sorted && std::is_sorted(arr.begin(), arr.end());
+
+            std::array<double, 23> darr;
+            for (double &val : darr) val = static_cast<double>( rng.bounded(1000)) / 7 - 50;
+            staticSort(darr, std::greater<double>());
+            sorted = sorted && std::is_sorted(darr.begin(), darr.end(), std::greater<double>());
+        }
+        UTEST_CHECK(utest_p, sorted);
+
+        std::array<std::string, 7> words = {{ "sort", "me", "up", "please", "by", "a", "network" }};
+        staticSort(words);
+        UTEST_CHECK(utest_p, std::is_sorted(words.begin(), words.end()));
+        UTEST_CHECK(utest_p, words.front() == "a" && words.back() == "up");
+
+        std::vector<UInt32> vec = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+        staticSort<5>(vec.begin() + 5);
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin() + 5, vec.end()) && vec[4] == 5);
+    }
+
+    // Alg::sort picks the network for arrays of known size, stable sorts and big arrays go the generic way
+    {
+        std::array<UInt32, 12> arr = {{ 23, 24, 4, 2, 4, 5, 6, 43, 8, 9, 1, 0 }};
+        Alg::sort(arr);
+        UTEST_CHECK(utest_p, std::is_sorted(arr.begin(), arr.end()));
+
+        UInt32 carr[] = { 23, 24, 4, 2, 4, 5, 6, 43, 8, 9, 1, 0 };
+        Alg::sort(carr, std::greater<UInt32>());
+        UTEST_CHECK(utest_p, std::is_sorted(carr, carr + 12, std::greater<UInt32>()));
+
+        // A built-in array passed as a range goes to the iterator overload
+        Alg::sort(carr, carr + 12);
+        UTEST_CHECK(utest_p, std::is_sorted(carr, carr + 12));
+
+        A aarr[] = { { 1, 5 }, { 2, 3 }, { 3, 5 }, { 4, 1 } };
+        Alg::sort(aarr, mycomp);
+        UTEST_CHECK(utest_p, std::is_sorted(aarr, aarr + 4, mycomp));
+
+        std::array<A, 20> data;
+        for (UInt32 i = 0; i < 20; i++) data[i] = A{ i, (i * 7) % 4 };
+        Alg::sort<Stable>(data, mycomp);
+        UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(),
+                                            [](const A& x, const A& y) { return x.b < y.b || (x.b == y.b && x.a < y.a); }));
+
+        std::array<UInt32, 1000> big;
+        for (UInt32 i = 0; i < big.size(); i++) big[i] = (i * 2654435761u) >> 7;
+        Alg::sort(big);
+        UTEST_CHECK(utest_p, std::is_sorted(big.begin(), big.end()));
+    }
+
+    return utest_p->result();
+}
+
 bool Alg::uTestHeap(UnitTest *utest_p)
 {
     PriorityQueue<UInt32> pq;
@@ -155,6 +424,92 @@ bool Alg::uTestHeap(UnitTest *utest_p)
     return utest_p->result();
 }
 
+/**
+ * Unit test for the external memory priority queue
+ */
+bool Alg::uTestExternalQueue(UnitTest *utest_p)
+{
+    // Tiny budget: 128 elements in the insertion heap, so the runs and the merges of levels are exercised
+    {
+        ExternalPriorityQueue<UInt32> queue(1024);
+        PriorityQueue<UInt32> check;
+        Xoshiro256 rng(5);
+
+        bool spilled = false;
+        bool same = true;
+        for (UInt32 i = 0; i < 20000; i++)
+        {
+            UInt32 val = static_cast<UInt32>(rng() % 5000);
+            queue.push(val);
+            check.push(val);
+            if ( i % 3 == 2)
+            {
+                same = same && queue.top() == check.top();
+                queue.pop();
+                check.pop();
+            }
+            spilled = spilled || queue.numRuns() > 0;
+        }
+        UTEST_CHECK(utest_p, spilled);
+        UTEST_CHECK(utest_p, queue.size() == check.size());
+
+        while ( !check.empty())
+        {
+            same = same && !queue.empty() && queue.top() == check.top();
+            queue.pop();
+            check.pop();
+        }
+        UTEST_CHECK(utest_p, same);
+        UTEST_CHECK(utest_p, queue.empty());
+    }
+
+    // Min-queue with the run files in the given directory
+    {
+        ExternalPriorityQueue<UInt64, std::greater<UInt64> > queue(256, ".");
+        for (UInt64 i = 1000; i > 0; i--) queue.push( (i * 7919) % 1000);
+        UTEST_CHECK(utest_p, queue.numRuns() > 0);
+
+        bool ordered = true;
+        for (UInt64 i = 0; i < 500; i++)
+        {
+            ordered = ordered && queue.top() == i;
+            queue.pop();
+        }
+        UTEST_CHECK(utest_p, ordered);
+        UTEST_CHECK(utest_p, queue.size() == 500);
+
+        queue.clear();
+        UTEST_CHECK(utest_p, queue.empty());
+        UTEST_CHECK(utest_p, queue.numRuns() == 0);
+
+        queue.push(3);
+        queue.push(1);
+        UTEST_CHECK(utest_p, queue.top() == 1);
+    }
+
+    // Queues that share the directory get their own run files
+    {
+        ExternalPriorityQueue<UInt64> first(256, "."), second(256, ".");
+        for (UInt64 i = 0; i < 1000; i++)
+        {
+            first.push(i);
+            second.push(1000 + i);
+        }
+        UTEST_CHECK(utest_p, first.numRuns() > 0 && second.numRuns() > 0);
+
+        bool ordered = true;
+        for (UInt64 i = 1000; i > 0; i--)
+        {
+            ordered = ordered && first.top() == i - 1 && second.top() == 999 + i;
+            first.pop();
+            second.pop();
+        }
+        UTEST_CHECK(utest_p, ordered && first.empty() && second.empty());
+    }
+
+    return utest_p->result();
+}
+
 
 bool Alg::uTestSort(UnitTest *utest_p)
 {
@@ -199,5 +554,1285 @@ bool Alg::uTestSort(UnitTest *utest_p)
         UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
     }
 
+    // Test merge sort with bounded buffer: from no buffer at all up to a full one, equal keys keep their order
+    {
+        std::vector<A> data;
+        for (UInt32 i = 0; i < 1000; i++)
+        {
+            A item = { i, (i * 37) % 101 % 13 };
+            data.push_back(item);
+        }
+
+        for (size_t buffer_size : { 0, 1, 7, 32, 500, 1000 })
+        {
+            std::vector<A> vec(data);
+            mergeSortBuffered(vec.begin(), vec.end(), buffer_size, mycomp);
+            UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end(),
+                                                [](const A& x, const A& y) { return x.b < y.b || (x.b == y.b && x.a < y.a); }));
+        }
+
+        std::string str("sort me up please");
+        mergeSortBuffered(str.begin(), str.end(), 2);
+        UTEST_CHECK(utest_p, std::is_sorted(str.begin(), str.end()));
+    }
+
+    return utest_p->result();
+}
+
+bool Alg::uTestSortBy(UnitTest *utest_p)
+{
+    // Key projection on the 'b' field, equal keys must keep their original order
+    auto by_b = [](const A& item) -> UInt32 { return item.b; };
+    auto stable_by_b = [](const A& x, const A& y) -> bool { return x.b < y.b || (x.b == y.b && x.a < y.a); };
+
+    // Test merge sort by projected key
+    {
+        std::vector<A> data = { { 1, 5 }, { 2, 3 }, { 3, 5 }, { 4, 1 }, { 5, 3 }, { 6, 0 }, { 7, 5 } };
+        mergeSortBy(data.begin(), data.end(), by_b);
+        UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(), stable_by_b));
+    }
+
+    // Test Shell's sort by projected key with a custom key comparison
+    {
+        std::vector<A> data = { { 1, 5 }, { 2, 3 }, { 3, 5 }, { 4, 1 }, { 5, 3 }, { 6, 0 }, { 7, 5 } };
+        shellSortBy(data.begin(), data.end(), by_b, std::greater<UInt32>());
+        UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(), 
+                                            [](const A& x, const A& y) { return x.b > y.b || (x.b == y.b && x.a < y.a); }));
+    }
+
+    // Test radix path for integral keys (including negative ones)
+    {
+        std::vector<Int32> vec = { 23, -24, 4, 2, 4, -5, 6, 43, 8, -9, 1, 0 };
+        sortBy(vec.begin(), vec.end(), [](Int32 v) { return v; });
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
+
+        std::vector<A> data = { { 1, 5 }, { 2, 3 }, { 3, 5 }, { 4, 1 }, { 5, 3 }, { 6, 0 }, { 7, 5 } };
+        sortBy(data.begin(), data.end(), by_b);
+        UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(), stable_by_b));
+    }
+
+    // Test 64-bit keys where only some digits vary, the passes of the constant digits are skipped
+    {
+        typedef std::pair<UInt64, UInt32> Pair;
+        std::vector<Pair> data;
+        for (UInt32 i = 0; i < 5000; i++)
+        {
+            UInt64 key = (UInt64( (i * 2654435761u) % 97) << 40) | (UInt64(i % 3) << 8) | 0x5a;
+            data.push_back( Pair(key, i));
+        }
+        std::vector<Pair> expected(data);
+        std::stable_sort(expected.begin(), expected.end(), [](const Pair& x, const Pair& y) { return x.first < y.first; });
+
+        sortBy(data.begin(), data.end(), [](const Pair& item) { return item.first; });
+        UTEST_CHECK(utest_p, data == expected);
+    }
+
+    // Test bool keys, they go to the merge path
+    {
+        std::vector<A> data = { { 1, 5 }, { 2, 0 }, { 3, 2 }, { 4, 0 }, { 5, 3 }, { 6, 0 }, { 7, 4 } };
+        sortBy(data.begin(), data.end(), [](const A& item) { return item.b != 0; });
+        UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(),
+                                            [](const A& x, const A& y) { return (x.b != 0) < (y.b != 0)
+                                                                                || ((x.b != 0) == (y.b != 0) && x.a < y.a); }));
+    }
+
+    // Test non-integral (string) keys
+    {
+        std::vector<std::string> vec = { "sort", "me", "up", "please", "by", "length" };
+        sortBy(vec.begin(), vec.end(), [](const std::string& s) { return s; });
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
+
+        sortBy(vec.begin(), vec.end(), [](const std::string& s) { return s.size(); });
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end(),
+                                            [](const std::string& x, const std::string& y) { return x.size() < y.size(); }));
+        UTEST_CHECK(utest_p, vec.front() == "by" && vec.back() == "please");
+    }
+
+    return utest_p->result();
+}
+
+
+bool Alg::uTestSortDispatch(UnitTest *utest_p)
+{
+    // Corpus of input shapes with sizes around the dispatch thresholds
+    enum Shape { Random, Sorted, Reversed, FewUnique, OrganPipe, NearlySorted, NumShapes };
+    auto make_input = [](Shape shape, UInt32 size) -> std::vector<UInt32>
+    {
+        std::vector<UInt32> vec(size);
+        for (UInt32 i = 0; i < size; i++)
+        {
+            switch (shape)
+            {
+            case Random:       vec[i] = (i * 2654435761u) >> 7; break;
+            case Sorted:       vec[i] = i; break;
+            case Reversed:     vec[i] = size - i; break;
+            case FewUnique:    vec[i] = (i * 2654435761u) >> 30; break;
+            case OrganPipe:    vec[i] = i < size / 2 ? i : size - i; break;
+            case NearlySorted: vec[i] = (i % 100 == 0) ? (i * 2654435761u) % size : i; break;
+            default: break;
+            }
+        }
+        return vec;
+    };
+
+    for (int shape = 0; shape < NumShapes; shape++)
+    {
+        for (UInt32 size : { 0, 1, 2, 10, 64, 65, 100, 127, 128, 1000, 5000 })
+        {
+            std::vector<UInt32> input = make_input(static_cast<Shape>(shape), size);
+
+            std::vector<UInt32> vec(input);
+            Alg::sort(vec.begin(), vec.end());
+            UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
+
+            vec = input;
+            Alg::sort(vec.begin(), vec.end(), std::greater<UInt32>());
+            UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end(), std::greater<UInt32>()));
+
+            std::vector<double> dvec(input.begin(), input.end());
+            for (double &d : dvec) d = d / 3 - 1000;
+            Alg::sort(dvec.begin(), dvec.end());
+            UTEST_CHECK(utest_p, std::is_sorted(dvec.begin(), dvec.end()));
+
+            // Structures compared by 'b', stable sort keeps the order of 'a'
+            std::vector<A> data;
+            for (UInt32 i = 0; i < size; i++)
+            {
+                A item = { i, input[i] % 16 };
+                data.push_back(item);
+            }
+            Alg::sort<Stable>(data.begin(), data.end(), mycomp);
+            UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end(),
+                                                [](const A& x, const A& y) { return x.b < y.b || (x.b == y.b && x.a < y.a); }));
+        }
+    }
+
+    // Signed zeros are equal, the stable sort keeps their order; so are NaNs with the neighbouring values
+    {
+        std::vector<double> input;
+        for (UInt32 i = 0; i < 5000; i++)
+        {
+            UInt32 r = (i * 2654435761u) >> 20;
+            input.push_back( r % 3 == 0 ? -0.0 : r % 3 == 1 ? 0.0 : static_cast<double>(r % 7) - 3.5);
+        }
+        auto same = [](const std::vector<double> &a, const std::vector<double> &b)
+        {
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                if ( std::memcmp(&a[i], &b[i], sizeof(double)) != 0) return false;
+            }
+            return a.size() == b.size();
+        };
+
+        std::vector<double> vec(input), expected(input);
+        Alg::sort<Stable>(vec.begin(), vec.end());
+        std::stable_sort(expected.begin(), expected.end());
+        UTEST_CHECK(utest_p, same(vec, expected));
+
+        vec = expected = input;
+        Alg::sort<Stable>(vec.begin(), vec.end(), std::greater<double>());
+        std::stable_sort(expected.begin(), expected.end(), std::greater<double>());
+        UTEST_CHECK(utest_p, same(vec, expected));
+
+        // With a NaN the radix path is not taken, the zeros stay in their order
+        input[2500] = std::numeric_limits<double>::quiet_NaN();
+        vec = input;
+        Alg::sort<Stable>(vec.begin(), vec.end());
+        std::vector<double> zeros, expected_zeros;
+        for (double d : vec) if (d == 0) zeros.push_back(d);
+        for (double d : input) if (d == 0) expected_zeros.push_back(d);
+        UTEST_CHECK(utest_p, same(zeros, expected_zeros));
+    }
+
+    // Bool elements: no radix path, the proxy references of std::vector<bool> go through the merge path
+    {
+        std::vector<bool> bits(5000);
+        for (size_t i = 0; i < bits.size(); i++) bits[i] = (i * 2654435761u) % 7 < 3;
+        size_t ones = std::count(bits.begin(), bits.end(), true);
+        Alg::sort(bits.begin(), bits.end());
+        UTEST_CHECK(utest_p, std::is_sorted(bits.begin(), bits.end())
+                             && static_cast<size_t>( std::count(bits.begin(), bits.end(), true)) == ones);
+
+        std::array<bool, 300> arr;
+        for (size_t i = 0; i < arr.size(); i++) arr[i] = i % 3 == 0;
+        Alg::sort(arr);
+        UTEST_CHECK(utest_p, std::is_sorted(arr.begin(), arr.end()) && std::count(arr.begin(), arr.end(), true) == 100);
+
+        Alg::sort<Stable>(arr, std::greater<bool>());
+        UTEST_CHECK(utest_p, std::is_sorted(arr.begin(), arr.end(), std::greater<bool>()));
+    }
+
+    // Characters of a string
+    {
+        std::string str("sort me up please, and do it quickly: the dispatcher picks the algorithm");
+        Alg::sort(str.begin(), str.end());
+        UTEST_CHECK(utest_p, std::is_sorted(str.begin(), str.end()));
+    }
+
+    return utest_p->result();
+}
+
+/**
+ * Unit test for the incremental sort
+ */
+bool Alg::uTestIncrementalSort(UnitTest *utest_p)
+{
+    const size_t size = 100000;
+    std::vector<UInt32> input(size);
+    for (size_t i = 0; i < size; i++) input[i] = static_cast<UInt32>( (i * 2654435761u) % 5000);
+    std::vector<UInt32> expected(input);
+    std::sort(expected.begin(), expected.end());
+
+    // next() resumes where it stopped, random access sorts only up to the requested element
+    {
+        std::vector<UInt32> vec(input);
+        auto sorter = incrementalSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, sorter.size() == size && !sorter.done());
+
+        std::vector<UInt32> page;
+        for (size_t i = 0; i < 20; i++) page.push_back( sorter.next());
+        UTEST_CHECK(utest_p, std::equal(page.begin(), page.end(), expected.begin()));
+        UTEST_CHECK(utest_p, sorter.position() == 20 && sorter.sorted() < size / 2);
+
+        for (size_t i = 0; i < 20; i++) page[i] = sorter.next();
+        UTEST_CHECK(utest_p, std::equal(page.begin(), page.end(), expected.begin() + 20));
+
+        UTEST_CHECK(utest_p, sorter[5000] == expected[5000] && sorter.position() == 40);
+        sorter.sortPrefix(10000);
+        UTEST_CHECK(utest_p, sorter.sorted() >= 10000 && std::equal(vec.begin(), vec.begin() + 10000, expected.begin()));
+
+        while ( !sorter.done()) sorter.next();
+        UTEST_CHECK(utest_p, vec == expected);
+    }
+
+    // Iteration in sorted order, custom comparison
+    {
+        std::vector<UInt32> vec(input);
+        IncrementalSort<std::vector<UInt32>::iterator, std::greater<UInt32> > sorter(vec.begin(), vec.end());
+        std::vector<UInt32> out(sorter.begin(), sorter.end());
+        UTEST_CHECK(utest_p, std::equal(out.begin(), out.end(), expected.rbegin()));
+
+        std::vector<UInt32> empty;
+        auto none = incrementalSort(empty.begin(), empty.end());
+        UTEST_CHECK(utest_p, none.done() && none.begin() == none.end());
+
+        std::vector<UInt32> sorted(expected), same(size, 7);
+        auto sorted_sorter = incrementalSort(sorted.begin(), sorted.end());
+        auto same_sorter = incrementalSort(same.begin(), same.end());
+        UTEST_CHECK(utest_p, sorted_sorter[size - 1] == expected.back() && same_sorter[size / 2] == 7);
+    }
+
+    // The first elements cost a linear number of comparisons, not a full sort
+    {
+        typedef Instrument::Counted<UInt32> Elem;
+        std::vector<Elem> vec(input.begin(), input.end());
+
+        Instrument::opCounts().reset();
+        auto sorter = incrementalSort(vec.begin(), vec.end());
+        for (size_t i = 0; i < 100; i++) sorter.next();
+        UTEST_CHECK(utest_p, Instrument::opCounts().compares < 4 * size);
+    }
+
     return utest_p->result();
-}
\ No newline at end of file
+}
+
+/** Record that refers to the characters of a string kept elsewhere */
+struct NamedRecord
+{
+    UInt32 id;
+    const std::string *name;
+};
+
+struct NamedRecordAccess
+{
+    const char *data(const NamedRecord &rec) const { return rec.name->data(); }
+    size_t size(const NamedRecord &rec) const { return rec.name->size(); }
+};
+
+/**
+ * Unit test for the string sorts
+ */
+bool Alg::uTestStringSort(UnitTest *utest_p)
+{
+    // URL-like strings with long common prefixes, duplicates, empty strings, zero and high characters
+    std::vector<std::string> input;
+    const char *hosts[] = { "https://example.com/", "https://example.com/static/", "https://example.org/" };
+    for (UInt32 i = 0; i < 20000; i++)
+    {
+        UInt32 h = (i * 2654435761u) >> 7;
+        input.push_back( std::string(hosts[h % 3]) + "page/" + std::to_string(h % 3000) + (h & 1 ? "/index" : ""));
+    }
+    input.push_back("");
+    input.push_back("");
+    input.push_back( std::string("https://example.com/\0", 21));
+    input.push_back( std::string("https://example.com/\0\0", 22));
+    input.push_back("https://example.com/\xff");
+    input.push_back("https://example.com/");
+
+    std::vector<std::string> expected(input);
+    std::sort(expected.begin(), expected.end());
+
+    {
+        std::vector<std::string> vec(input);
+        multikeyQuickSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, vec == expected);
+
+        vec = input;
+        stringRadixSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, vec == expected);
+
+        vec = input;
+        std::vector<size_t> lcp;
+        lcpMergeSort(vec.begin(), vec.end(), lcp);
+        UTEST_CHECK(utest_p, vec == expected && lcp.size() == vec.size() && lcp[0] == 0);
+
+        bool lcp_ok = true;
+        for (size_t i = 1; i < vec.size(); i++)
+        {
+            size_t common = std::mismatch(vec[i - 1].begin(), vec[i - 1].begin() + std::min(vec[i - 1].size(), vec[i].size()),
+                                          vec[i].begin()).second - vec[i].begin();
+            lcp_ok = lcp_ok && lcp[i] == common;
+        }
+        UTEST_CHECK(utest_p, lcp_ok);
+    }
+
+    // Pointer and length records, C strings and string views refer to the strings without copying them
+    {
+        typedef std::pair<const char *, size_t> Ref;
+        std::vector<Ref> refs;
+        for (const std::string &str : input) refs.push_back( Ref(str.data(), str.size()));
+        stringRadixSort(refs.begin(), refs.end());
+        bool same = true;
+        for (size_t i = 0; i < refs.size(); i++) same = same && std::string(refs[i].first, refs[i].second) == expected[i];
+        UTEST_CHECK(utest_p, same);
+
+        // Equal strings keep the input order, in the radix passes and in the short groups sorted by comparisons
+        std::vector<Ref> input_pos; // Characters of the input strings and their positions, by the address
+        for (size_t i = 0; i < input.size(); i++) input_pos.push_back( Ref(input[i].data(), i));
+        std::sort(input_pos.begin(), input_pos.end());
+        auto pos_of = [&input_pos](const Ref &ref) { return std::lower_bound(input_pos.begin(), input_pos.end(), Ref(ref.first, 0))->second; };
+
+        bool stable = true;
+        for (size_t i = 1; i < refs.size(); i++)
+        {
+            if ( expected[i - 1] == expected[i]) stable = stable && pos_of(refs[i - 1]) < pos_of(refs[i]);
+        }
+        UTEST_CHECK(utest_p, stable);
+
+        std::vector<const char *> c_strs = { "pear", "apple", "", "apples", "app" };
+        multikeyQuickSort(c_strs.begin(), c_strs.end());
+        UTEST_CHECK(utest_p, std::string(c_strs[0]).empty() && std::string(c_strs[1]) == "app" && std::string(c_strs[4]) == "pear");
+
+#if __cplusplus >= 201703L
+        std::vector<std::string_view> views(input.begin(), input.end());
+        std::vector<size_t> lcp;
+        lcpMergeSort(views.begin(), views.end(), lcp);
+        UTEST_CHECK(utest_p, std::equal(views.begin(), views.end(), expected.begin()));
+#endif
+    }
+
+    // Long common prefixes do not deepen the recursion of the radix sort: 256 identical records of 1M characters
+    {
+        typedef std::pair<const char *, size_t> Ref;
+        const size_t prefix = 1 << 20;
+        std::string chars(prefix + 4, 'a');
+
+        std::vector<Ref> refs;
+        for (size_t i = 0; i < 300; i++) refs.push_back( Ref(chars.data(), prefix + (i < 256 ? 0 : (i * 7) % 5)));
+        stringRadixSort(refs.begin(), refs.end());
+        UTEST_CHECK(utest_p, std::is_sorted(refs.begin(), refs.end()) && refs[255].second == prefix);
+    }
+
+    // Radix and LCP merge sorts are stable
+    {
+        std::vector<NamedRecord> records;
+        for (UInt32 i = 0; i < input.size(); i++) records.push_back( NamedRecord{ i, &input[i % 500] });
+        auto in_order = [](const NamedRecord &a, const NamedRecord &b)
+        {
+            return *a.name < *b.name || (*a.name == *b.name && a.id < b.id);
+        };
+
+        std::vector<NamedRecord> sorted(records);
+        stringRadixSort(sorted.begin(), sorted.end(), NamedRecordAccess());
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), in_order));
+
+        sorted = records;
+        std::vector<size_t> lcp;
+        lcpMergeSort(sorted.begin(), sorted.end(), lcp, NamedRecordAccess());
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), in_order));
+
+        sorted = records;
+        multikeyQuickSort(sorted.begin(), sorted.end(), NamedRecordAccess());
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(),
+                                            [](const NamedRecord &a, const NamedRecord &b) { return *a.name < *b.name; }));
+
+        std::vector<std::string> empty;
+        stringRadixSort(empty.begin(), empty.end());
+        multikeyQuickSort(empty.begin(), empty.end());
+        lcpMergeSort(empty.begin(), empty.end(), lcp);
+        UTEST_CHECK(utest_p, lcp.empty());
+    }
+
+    return utest_p->result();
+}
+
+/** Sorted set of random keys below the bound, keeps the extreme keys sometimes */
+static std::vector<UInt32> randomSet(Xoshiro256 &rng, size_t size, UInt64 bound)
+{
+    std::vector<UInt32> set;
+    for (size_t i = 0; i < size; i++) set.push_back( static_cast<UInt32>(rng() % bound));
+    if ( size > 0 && rng() % 2 == 0) set.front() = 0;
+    if ( size > 1 && rng() % 2 == 0) set.back() = 0xffffffff;
+    std::sort(set.begin(), set.end());
+    set.erase( std::unique(set.begin(), set.end()), set.end());
+    return set;
+}
+
+/** Check the set operations on two sets against the standard algorithms */
+template <class Compare>
+static bool checkSetOps(const std::vector<UInt32> &a, const std::vector<UInt32> &b, Compare comp)
+{
+    std::vector<UInt32> res, expected;
+
+    setIntersect(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(res), comp);
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected), comp);
+    bool ok = res == expected;
+
+    res.clear();
+    expected.clear();
+    setUnion(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(res), comp);
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected), comp);
+    ok = ok && res == expected;
+
+    res.clear();
+    expected.clear();
+    setDifference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(res), comp);
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected), comp);
+    return ok && res == expected;
+}
+
+/**
+ * Unit test for the operations on sorted sets
+ */
+bool Alg::uTestSetOps(UnitTest *utest_p)
+{
+    Xoshiro256 rng(17);
+    auto scalar_less = [](UInt32 a, UInt32 b) { return a < b; };
+
+    // Kernels and the scalar loop on sets of similar sizes, dense and sparse
+    {
+        bool kernel_ok = true;
+        bool scalar_ok = true;
+        for (size_t i = 0; i < 200; i++)
+        {
+            UInt64 bound = (i % 2 == 0) ? 4000 : 1ull << 32;
+            std::vector<UInt32> a = randomSet(rng, rng() % 2000, bound);
+            std::vector<UInt32> b = randomSet(rng, rng() % 2000, bound);
+            if ( a.size() * SetOps::gallop_ratio < b.size() || b.size() * SetOps::gallop_ratio < a.size()) continue;
+
+            kernel_ok = kernel_ok && checkSetOps(a, b, std::less<UInt32>());
+            scalar_ok = scalar_ok && checkSetOps(a, b, scalar_less);
+        }
+        UTEST_CHECK(utest_p, kernel_ok);
+        UTEST_CHECK(utest_p, scalar_ok);
+
+        // Identical and disjoint sets
+        std::vector<UInt32> a = randomSet(rng, 1000, 100000);
+        std::vector<UInt32> odd, even;
+        for (UInt32 i = 0; i < 1000; i++) (i % 2 ? odd : even).push_back(i);
+        UTEST_CHECK(utest_p, checkSetOps(a, a, std::less<UInt32>()));
+        UTEST_CHECK(utest_p, checkSetOps(odd, even, std::less<UInt32>()));
+        UTEST_CHECK(utest_p, checkSetOps(even, odd, std::less<UInt32>()));
+    }
+
+    // Galloping on skewed sizes, the small set in either place
+    {
+        bool ok = true;
+        for (size_t i = 0; i < 50; i++)
+        {
+            std::vector<UInt32> big = randomSet(rng, 20000, 40000);
+            std::vector<UInt32> small = randomSet(rng, rng() % 100, 40000);
+            ok = ok && checkSetOps(small, big, std::less<UInt32>()) && checkSetOps(big, small, std::less<UInt32>());
+            ok = ok && checkSetOps(small, big, scalar_less) && checkSetOps(big, small, scalar_less);
+        }
+        UTEST_CHECK(utest_p, ok);
+
+        std::vector<UInt32> empty;
+        UTEST_CHECK(utest_p, checkSetOps(empty, randomSet(rng, 100, 1000), std::less<UInt32>()));
+        UTEST_CHECK(utest_p, checkSetOps(randomSet(rng, 100, 1000), empty, std::less<UInt32>()));
+    }
+
+    // Pointers, descending order and other types
+    {
+        std::vector<UInt32> a = randomSet(rng, 500, 1000);
+        std::vector<UInt32> b = randomSet(rng, 700, 1000);
+        std::vector<UInt32> res(a.size());
+        std::vector<UInt32> expected;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+        UInt32 *end = setIntersect(a.data(), a.data() + a.size(), b.data(), b.data() + b.size(), res.data());
+        UTEST_CHECK(utest_p, std::vector<UInt32>(res.data(), end) == expected);
+
+        std::reverse(a.begin(), a.end());
+        std::reverse(b.begin(), b.end());
+        UTEST_CHECK(utest_p, checkSetOps(a, b, std::greater<UInt32>()));
+
+        std::vector<std::string> s1 = { "ant", "bee", "cat", "dog" };
+        std::vector<std::string> s2 = { "bee", "dog", "eel" };
+        std::vector<std::string> s_res;
+        setUnion(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(s_res));
+        UTEST_CHECK(utest_p, s_res.size() == 5 && std::is_sorted(s_res.begin(), s_res.end()));
+    }
+
+    // Intersection of k sets
+    {
+        std::vector<std::vector<UInt32> > lists;
+        lists.push_back( randomSet(rng, 5000, 10000));
+        lists.push_back( randomSet(rng, 3000, 10000));
+        lists.push_back( randomSet(rng, 100, 10000));
+        lists.push_back( randomSet(rng, 8000, 10000));
+
+        std::vector<UInt32> expected = lists[0];
+        for (size_t i = 1; i < lists.size(); i++)
+        {
+            std::vector<UInt32> next;
+            std::set_intersection(expected.begin(), expected.end(), lists[i].begin(), lists[i].end(),
+                                  std::back_inserter(next));
+            expected.swap(next);
+        }
+
+        typedef std::vector<UInt32>::const_iterator Iterator;
+        std::vector<std::pair<Iterator, Iterator> > sets;
+        for (const std::vector<UInt32> &list : lists) sets.push_back( std::make_pair(list.begin(), list.end()));
+
+        std::vector<UInt32> res;
+        setIntersect(sets, res);
+        UTEST_CHECK(utest_p, res == expected);
+
+        sets.resize(1);
+        setIntersect(sets, res);
+        UTEST_CHECK(utest_p, res == lists[0]);
+
+        sets.clear();
+        setIntersect(sets, res);
+        UTEST_CHECK(utest_p, res.empty());
+    }
+
+    return utest_p->result();
+}
+
+
+bool Alg::uTestWorkspace(UnitTest *utest_p)
+{
+    // Arena: aligned allocations, growth over the block size and reuse after release
+    {
+        Arena arena(256);
+        for (int i = 0; i < 100; i++)
+        {
+            void *ptr = arena.allocate(24, 16);
+            UTEST_CHECK(utest_p, reinterpret_cast<size_t>(ptr) % 16 == 0);
+        }
+        void *big = arena.allocate(10000, 8);
+        UTEST_CHECK(utest_p, big != nullptr);
+        UTEST_CHECK(utest_p, arena.bytesUsed() == 100 * 24 + 10000);
+
+        arena.release();
+        UTEST_CHECK(utest_p, arena.bytesUsed() == 0);
+        void *again = arena.allocate(10000, 8);
+        UTEST_CHECK(utest_p, again == big); // the biggest block is kept
+    }
+
+    // Priority queue and a standard container on top of the arena
+    {
+        Arena arena;
+        {
+            PriorityQueue<UInt32, ArenaAllocator<UInt32> > pq( (ArenaAllocator<UInt32>(arena)) );
+            for (UInt32 i = 0; i < 1000; i++) pq.push((i * 2654435761u) % 1000);
+            UTEST_CHECK(utest_p, arena.bytesUsed() > 0);
+            UTEST_CHECK(utest_p, pq.size() == 1000);
+
+            UInt32 prev = pq.top();
+            bool ordered = true;
+            while (!pq.empty())
+            {
+                ordered = ordered && pq.top() <= prev;
+                prev = pq.top();
+                pq.pop();
+            }
+            UTEST_CHECK(utest_p, ordered);
+
+            std::vector<A, ArenaAllocator<A> > vec( (ArenaAllocator<A>(arena)) );
+            for (UInt32 i = 0; i < 100; i++) vec.push_back(A{ i, 100 - i });
+            UTEST_CHECK(utest_p, vec.front().a == 0 && vec.back().b == 1);
+        }
+        arena.release();
+        UTEST_CHECK(utest_p, arena.bytesUsed() == 0);
+    }
+
+    // Sorts with a workspace give the same result as without it, the buffers are reused between the calls
+    {
+        Workspace ws;
+        for (UInt32 size : { 0, 1, 10, 100, 1000, 5000, 300 })
+        {
+            std::vector<UInt32> input(size);
+            for (UInt32 i = 0; i < size; i++) input[i] = (i * 2654435761u) >> 9;
+            std::vector<UInt32> expected(input);
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<UInt32> vec(input);
+            mergeSort(vec.begin(), vec.end(), ws);
+            UTEST_CHECK(utest_p, vec == expected);
+
+            vec = input;
+            mergeSortBU(vec.begin(), vec.end(), ws);
+            UTEST_CHECK(utest_p, vec == expected);
+
+            vec = input;
+            mergeSortBuffered(vec.begin(), vec.end(), 16, ws);
+            UTEST_CHECK(utest_p, vec == expected);
+
+            vec = input;
+            Alg::sort(vec.begin(), vec.end(), ws);
+            UTEST_CHECK(utest_p, vec == expected);
+
+            vec = input;
+            Alg::sort(vec.begin(), vec.end(), ws, std::greater<UInt32>());
+            UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end(), std::greater<UInt32>()));
+
+            vec = input;
+            sortBy(vec.begin(), vec.end(), [](UInt32 v) { return v; }, ws);
+            UTEST_CHECK(utest_p, vec == expected);
+
+            std::vector<A> data;
+            for (UInt32 i = 0; i < size; i++) data.push_back(A{ i, input[i] % 16 });
+            auto stable_by_b = [](const A& x, const A& y) -> bool { return x.b < y.b || (x.b == y.b && x.a < y.a); };
+
+            std::vector<A> sorted(data);
+            mergeSortBy(sorted.begin(), sorted.end(), [](const A& item) { return item.b; }, ws);
+            UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), stable_by_b));
+
+            sorted = data;
+            radixSortBy(sorted.begin(), sorted.end(), [](const A& item) { return item.b; }, ws);
+            UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), stable_by_b));
+
+            sorted = data;
+            Alg::sort<Stable>(sorted.begin(), sorted.end(), ws, mycomp);
+            UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), stable_by_b));
+        }
+
+        // The buffer grew to the biggest input and stayed there
+        UTEST_CHECK(utest_p, ws.buffer<UInt32>(0).size() >= 5000);
+        ws.release();
+        UTEST_CHECK(utest_p, ws.buffer<UInt32>(0).empty());
+    }
+
+    return utest_p->result();
+}
+
+/**
+ * Unit test for the storage of big arrays
+ */
+bool Alg::uTestLargeStorage(UnitTest *utest_p)
+{
+    const StoragePages pages[] = { SmallPages, TransparentHugePages, ExplicitHugePages };
+    const StoragePlacement placements[] = { LocalPlacement, InterleavedPlacement, SpreadPlacement };
+    const size_t min_bytes = 64 * 1024; // Low threshold so that the test arrays are mapped
+
+    UTEST_CHECK(utest_p, Storage::numaNodes() >= 1);
+    UTEST_CHECK(utest_p, !StorageOptions().special(size_t(1) << 40));
+    UTEST_CHECK(utest_p, !StorageOptions(TransparentHugePages).special(1024));
+
+    // Every combination of the options, explicit huge pages fall back to the transparent ones if none are reserved
+    for (StoragePages page : pages)
+    {
+        for (StoragePlacement placement : placements)
+        {
+            StorageOptions options(page, placement, min_bytes);
+            LargeAllocator<UInt64> alloc(options);
+
+            std::vector<UInt64, LargeAllocator<UInt64> > vec(100000, 0, alloc);
+            for (size_t i = 0; i < vec.size(); i++) vec[i] = i;
+            vec.resize(300000, 7);
+            bool ok = vec[99999] == 99999 && vec[100000] == 7 && vec.back() == 7;
+            UTEST_CHECK(utest_p, ok);
+            UTEST_CHECK(utest_p, vec.get_allocator() == alloc);
+
+            std::vector<UInt64, LargeAllocator<UInt64> > small(10, 1, alloc);
+            UTEST_CHECK(utest_p, small.back() == 1);
+
+            // Union-find with the nodes united into chains of 3
+            const UInt32 size = 30000;
+            UF< TreeUF<> > uf(size, options);
+            for (UInt32 i = 0; i + 1 < size; i++)
+            {
+                if ( i % 3 != 2) uf.unite(i, i + 1);
+            }
+            UTEST_CHECK(utest_p, uf.areConnected(0, 2) && !uf.areConnected(2, 3) && uf.areConnected(size - 3, size - 1));
+
+            // Priority queue on the allocator
+            PriorityQueue<UInt32, LargeAllocator<UInt32> > queue( (LargeAllocator<UInt32>(options)));
+            for (UInt32 i = 0; i < 50000; i++) queue.push( (i * 7919) % 50000);
+            bool ordered = true;
+            for (UInt32 i = 50000; i > 0; i--)
+            {
+                ordered = ordered && queue.top() == i - 1;
+                queue.pop();
+            }
+            UTEST_CHECK(utest_p, ordered);
+
+            // Sort scratch from a workspace
+            Workspace ws(options);
+            std::vector<UInt32> data;
+            for (UInt32 i = 0; i < 40000; i++) data.push_back( (i * 7919) % 40000);
+            mergeSort(data.begin(), data.end(), ws);
+            UTEST_CHECK(utest_p, std::is_sorted(data.begin(), data.end()) && data.back() == 39999);
+            UTEST_CHECK(utest_p, ws.buffer<UInt32>(0).size() >= 40000);
+            UTEST_CHECK(utest_p, ws.buffer<UInt32>(0).get_allocator().storage() == options);
+
+            // A growing buffer keeps its contents, from ordinary memory to a mapping and between mappings
+            std::vector<UInt32, LargeAllocator<UInt32> > &buf = ws.buffer<UInt32>(10, 1);
+            for (UInt32 i = 0; i < 10; i++) buf[i] = i;
+            ws.buffer<UInt32>(100000, 1);
+            ws.buffer<UInt32>(1000000, 1);
+            UTEST_CHECK(utest_p, buf.size() >= 1000000 && buf[0] == 0 && buf[9] == 9);
+        }
+    }
+
+    return utest_p->result();
+}
+
+bool Alg::uTestShuffle(UnitTest *utest_p)
+{
+    std::vector<UInt32> data;
+    for (UInt32 i = 0; i < 1000; i++) data.push_back(i);
+
+    // Seeded shuffle is a reproducible permutation
+    {
+        Xoshiro256 rng1(42), rng2(42);
+        std::vector<UInt32> vec1(data), vec2(data);
+        shuffle(vec1.begin(), vec1.end(), rng1);
+        shuffle(vec2.begin(), vec2.end(), rng2);
+        UTEST_CHECK(utest_p, vec1 == vec2);
+        UTEST_CHECK(utest_p, vec1 != data);
+        UTEST_CHECK(utest_p, std::is_permutation(vec1.begin(), vec1.end(), data.begin()));
+
+        std::mt19937 gen(42);
+        shuffle(vec2.begin(), vec2.end(), gen);
+        UTEST_CHECK(utest_p, std::is_permutation(vec2.begin(), vec2.end(), data.begin()));
+
+        // Our generator works with the standard algorithms as well
+        std::shuffle(vec2.begin(), vec2.end(), rng1);
+        UTEST_CHECK(utest_p, std::is_permutation(vec2.begin(), vec2.end(), data.begin()));
+    }
+
+    // Bounded ranges stay in range
+    {
+        Xoshiro256 rng(7);
+        bool in_range = true;
+        for (UInt64 range : { 1ull, 3ull, 1000ull, 0x100000000ull, 0x8000000000000001ull })
+        {
+            for (int i = 0; i < 1000; i++) in_range = in_range && rng.bounded(range) < range;
+        }
+        UTEST_CHECK(utest_p, in_range);
+    }
+
+    // All 24 permutations of 4 elements are equally likely for Fisher-Yates and for the MergeShuffle merges
+    for (int merge_shuffle = 0; merge_shuffle < 2; merge_shuffle++)
+    {
+        Xoshiro256 rng(2015);
+        std::vector<UInt32> counts(256, 0);
+        const int trials = 24000;
+
+        for (int t = 0; t < trials; t++)
+        {
+            std::vector<UInt32> vec = { 0, 1, 2, 3 };
+            if (merge_shuffle) Shuffle::mergeShuffle(vec.begin(), vec.end(), rng, 1, 1);
+            else shuffle(vec.begin(), vec.end(), rng);
+            counts[vec[0] * 64 + vec[1] * 16 + vec[2] * 4 + vec[3]]++;
+        }
+
+        UInt32 num_perms = 0;
+        bool uniform = true;
+        for (UInt32 count : counts)
+        {
+            if (count == 0) continue;
+            num_perms++;
+            uniform = uniform && count > 850 && count < 1150; // Expected 1000, sigma is about 31
+        }
+        UTEST_CHECK(utest_p, num_perms == 24);
+        UTEST_CHECK(utest_p, uniform);
+    }
+
+    // Parallel MergeShuffle does not depend on the number of threads
+    {
+        std::vector<UInt32> big;
+        for (UInt32 i = 0; i < 300000; i++) big.push_back(i);
+
+        Xoshiro256 rng1(1), rng2(1);
+        std::vector<UInt32> vec1(big), vec2(big);
+        Shuffle::mergeShuffle(vec1.begin(), vec1.end(), rng1, 1, 1000);
+        Shuffle::mergeShuffle(vec2.begin(), vec2.end(), rng2, 4, 1000);
+        UTEST_CHECK(utest_p, vec1 == vec2);
+        UTEST_CHECK(utest_p, vec1 != big);
+
+        mergeShuffle(vec1.begin(), vec1.end(), rng1);
+        std::sort(vec1.begin(), vec1.end());
+        UTEST_CHECK(utest_p, vec1 == big);
+    }
+
+    // Partial shuffle and reservoir sampling give distinct elements of the input
+    {
+        Xoshiro256 rng(3);
+        std::vector<UInt32> vec(data);
+        auto end = sample(vec.begin(), vec.end(), 10, rng);
+        UTEST_CHECK(utest_p, end - vec.begin() == 10);
+        std::sort(vec.begin(), end);
+        UTEST_CHECK(utest_p, std::adjacent_find(vec.begin(), end) == end);
+        UTEST_CHECK(utest_p, std::is_permutation(vec.begin(), vec.end(), data.begin()));
+
+        std::vector<UInt32> reservoir(10);
+        UTEST_CHECK(utest_p, reservoirSample(data.begin(), data.end(), reservoir.begin(), 10, rng) == 10);
+        std::sort(reservoir.begin(), reservoir.end());
+        UTEST_CHECK(utest_p, std::adjacent_find(reservoir.begin(), reservoir.end()) == reservoir.end());
+        UTEST_CHECK(utest_p, reservoir.back() < 1000);
+
+        UTEST_CHECK(utest_p, reservoirSample(data.begin(), data.begin() + 5, reservoir.begin(), 10, rng) == 5);
+    }
+
+    return utest_p->result();
+}
+
+/**
+ * Unit test for the execution policies and the thread pool
+ */
+bool Alg::uTestExecution(UnitTest *utest_p)
+{
+    ThreadPool &pool = ThreadPool::instance();
+    ThreadPool::Config config;
+    config.num_threads = 4;
+    pool.configure(config);
+    UTEST_CHECK(utest_p, pool.numThreads() == 4);
+
+    // Every index is run exactly once, exceptions of the tasks reach the caller
+    {
+        std::vector<std::atomic<UInt32> > runs(10000);
+        for (std::atomic<UInt32> &r : runs) r = 0;
+        pool.parallelFor(runs.size(), [&](size_t i) { runs[i]++; });
+        UTEST_CHECK(utest_p, std::all_of(runs.begin(), runs.end(), [](const std::atomic<UInt32> &r) { return r == 1; }));
+
+        bool caught = false;
+        try
+        {
+            pool.parallelFor(100, [](size_t i) { if (i == 57) throw std::runtime_error("task failed"); });
+        } catch (const std::runtime_error &)
+        {
+            caught = true;
+        }
+        UTEST_CHECK(utest_p, caught);
+
+        // Nested parallel loops do not deadlock
+        std::atomic<UInt32> total(0);
+        pool.parallelFor(8, [&](size_t) { pool.parallelFor(100, [&](size_t) { total++; }); });
+        UTEST_CHECK(utest_p, total == 800);
+    }
+
+    std::vector<UInt32> input(200000);
+    for (UInt32 i = 0; i < input.size(); i++) input[i] = (i * 2654435761u) >> 11;
+    std::vector<UInt32> expected(input);
+    std::sort(expected.begin(), expected.end());
+
+    // Parallel sorts give the sequential results
+    {
+        std::vector<UInt32> vec(input);
+        Alg::sort(execution::par, vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, vec == expected);
+
+        vec = input;
+        Alg::sort(execution::seq, vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, vec == expected);
+
+        vec = input;
+        mergeSort(execution::par, vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, vec == expected);
+
+        vec = input;
+        mergeSortBU(execution::par_unseq, vec.begin(), vec.end(), std::greater<UInt32>());
+        UTEST_CHECK(utest_p, std::equal(vec.begin(), vec.end(), expected.rbegin()));
+
+        std::vector<A> data;
+        for (UInt32 i = 0; i < input.size(); i++) data.push_back(A{ i, input[i] % 100 });
+        auto stable_by_b = [](const A& x, const A& y) -> bool { return x.b < y.b || (x.b == y.b && x.a < y.a); };
+
+        std::vector<A> sorted(data);
+        Alg::sort<Stable>(execution::par, sorted.begin(), sorted.end(), mycomp);
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), stable_by_b));
+
+        sorted = data;
+        sortBy(execution::par, sorted.begin(), sorted.end(), [](const A& item) { return item.b; });
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(), stable_by_b));
+
+        sorted = data;
+        sortBy(execution::par, sorted.begin(), sorted.end(), [](const A& item) { return item.b; }, std::greater<UInt32>());
+        UTEST_CHECK(utest_p, std::is_sorted(sorted.begin(), sorted.end(),
+                                            [](const A& x, const A& y) { return x.b > y.b || (x.b == y.b && x.a < y.a); }));
+    }
+
+    // Parallel merge is stable
+    {
+        std::vector<A> data;
+        for (UInt32 i = 0; i < 100000; i++) data.push_back(A{ i, (i % 50000) / 7 });
+        std::vector<A> merged(data.size()), expected_merge(data.size());
+
+        auto middle = data.begin() + 50000;
+        merge(data.begin(), middle, middle, data.end(), expected_merge.begin(), mycomp);
+        merge(execution::par, data.begin(), middle, middle, data.end(), merged.begin(), mycomp);
+        UTEST_CHECK(utest_p, std::equal(merged.begin(), merged.end(), expected_merge.begin(),
+                                        [](const A& x, const A& y) { return x.a == y.a; }));
+    }
+
+    // Parallel shuffle is a permutation that does not depend on the number of threads
+    {
+        Xoshiro256 rng1(5), rng2(5);
+        std::vector<UInt32> vec1(input), vec2(input);
+        shuffle(execution::par, vec1.begin(), vec1.end(), rng1);
+
+        config.num_threads = 2;
+        pool.configure(config);
+        shuffle(execution::par, vec2.begin(), vec2.end(), rng2);
+        UTEST_CHECK(utest_p, vec1 == vec2);
+        UTEST_CHECK(utest_p, vec1 != input);
+
+        std::sort(vec1.begin(), vec1.end());
+        UTEST_CHECK(utest_p, vec1 == expected);
+
+        std::mt19937 gen(5);
+        shuffle(execution::par, vec2.begin(), vec2.end(), gen);
+        std::sort(vec2.begin(), vec2.end());
+        UTEST_CHECK(utest_p, vec2 == expected);
+    }
+
+    // Batched searches
+    {
+        std::vector<UInt32> queries(50000);
+        for (UInt32 i = 0; i < queries.size(); i++) queries[i] = (i * 40503u) >> 3;
+
+        std::vector<size_t> seq_results, par_results;
+        lowerBoundBatch(queries, expected, seq_results);
+        lowerBoundBatch(execution::par, queries, expected, par_results);
+        UTEST_CHECK(utest_p, seq_results == par_results);
+
+        binSearchBatch(queries, expected, seq_results);
+        binSearchBatch(execution::par, queries, expected, par_results);
+        UTEST_CHECK(utest_p, seq_results == par_results);
+    }
+
+    // Batched union-find operations
+    {
+        const UInt32 size = 100000;
+        UFPairs edges, queries;
+        for (UInt32 i = 0; i < 60000; i++) edges.push_back( std::make_pair( (i * 7919u) % size, (i * 104729u) % size));
+        for (UInt32 i = 0; i < 20000; i++) queries.push_back( std::make_pair( (i * 31u) % size, (i * 6007u) % size));
+
+        UF< TreeUF<> > seq_uf(size), par_uf(size);
+        uniteBatch(seq_uf, edges);
+        uniteBatch(execution::par, par_uf, edges);
+
+        std::vector<UInt8> seq_results, par_results;
+        areConnectedBatch(seq_uf, queries, seq_results);
+        areConnectedBatch(execution::par, par_uf, queries, par_results);
+        UTEST_CHECK(utest_p, seq_results == par_results);
+        UTEST_CHECK(utest_p, std::count(par_results.begin(), par_results.end(), 1) > 0);
+
+        PlainUF plain(1000);
+        UFPairs few = { { 1, 2 }, { 2, 3 }, { 5, 6 } };
+        uniteBatch(execution::par, plain, few);
+        UTEST_CHECK(utest_p, plain.areConnected(1, 3) && !plain.areConnected(3, 5));
+    }
+
+    // Back to the default configuration
+    pool.configure( ThreadPool::Config());
+
+    return utest_p->result();
+}
+
+/**
+ * Unit test for the instrumentation
+ */
+bool Alg::uTestInstrument(UnitTest *utest_p)
+{
+    using namespace Instrument;
+    typedef Counted<UInt32> Elem;
+
+    const UInt32 size = 100;
+    std::vector<Elem> sorted, reversed, random;
+    for (UInt32 i = 0; i < size; i++)
+    {
+        sorted.push_back(i);
+        reversed.push_back(size - i);
+        random.push_back((i * 2654435761u) >> 8);
+    }
+
+    // Wrapper counts every kind of operation
+    {
+        Elem a(1), b(2);
+        opCounts().reset();
+        Elem c(a);
+        Elem d(std::move(b));
+        c = d;
+        d = std::move(a);
+        std::iter_swap(&c, &d);
+        UTEST_CHECK(utest_p, c < d || d < c);
+        UTEST_CHECK(utest_p, opCounts().copies == 2 && opCounts().moves == 2);
+        UTEST_CHECK(utest_p, opCounts().swaps == 1 && opCounts().compares >= 1);
+    }
+
+    // Counts of the trivial sorts are known exactly
+    {
+        std::vector<Elem> vec(sorted);
+        opCounts().reset();
+        bubbleSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, opCounts().compares == size - 1 && opCounts().swaps == 0);
+
+        vec = reversed;
+        opCounts().reset();
+        insertionSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, opCounts().swaps == size * (size - 1) / 2);
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
+
+        vec = random;
+        opCounts().reset();
+        selectionSort(vec.begin(), vec.end());
+        UTEST_CHECK(utest_p, opCounts().compares == size * (size + 1) / 2 && opCounts().swaps == size);
+    }
+
+    // Merge sort stays within n * log2(n) compares, the counting comparison sees the same number
+    {
+        std::vector<Elem> vec(random);
+        opCounts().reset();
+        mergeSort(vec.begin(), vec.end());
+        OpCounts counted = opCounts();
+        UTEST_CHECK(utest_p, counted.compares <= size * 7);
+        UTEST_CHECK(utest_p, counted.copies + counted.moves > 0);
+        UTEST_CHECK(utest_p, std::is_sorted(vec.begin(), vec.end()));
+
+        std::vector<UInt32> plain;
+        for (const Elem &elem : random) plain.push_back(elem.value());
+        opCounts().reset();
+        mergeSort(plain.begin(), plain.end(), countingCompare(std::less<UInt32>()));
+        UTEST_CHECK(utest_p, opCounts().compares == counted.compares);
+        UTEST_CHECK(utest_p, opCounts().copies == 0 && opCounts().moves == 0);
+    }
+
+    // Priority queue operations
+    {
+        PriorityQueue<Elem> queue;
+        opCounts().reset();
+        for (const Elem &elem : random) queue.push(elem);
+        while ( !queue.empty()) queue.pop();
+        UTEST_CHECK(utest_p, opCounts().compares > 0 && opCounts().swaps > 0);
+    }
+
+    // Hardware counters are either not available or count something
+    {
+        PerfCounters counters;
+        std::vector<UInt32> vec(10000, 1);
+        {
+            PerfScope scope(counters);
+            std::sort(vec.begin(), vec.end());
+        }
+        if ( counters.available(PerfCounters::Instructions))
+        {
+            UTEST_CHECK(utest_p, counters.value(PerfCounters::Instructions) > 0);
+        }
+        UTEST_CHECK(utest_p, counters.available(PerfCounters::Cycles) || counters.value(PerfCounters::Cycles) == 0);
+    }
+
+    return utest_p->result();
+}
+
+/** Depths of the vertices by a plain BFS, no_vertex for the unreached ones */
+static std::vector<UInt32> bfsDepths(const Graph<> &graph, UInt32 source)
+{
+    std::vector<UInt32> depth(graph.numVertices(), no_vertex);
+    std::vector<UInt32> queue(1, source);
+    depth[source] = 0;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        UInt32 u = queue[head];
+        for (UInt32 i = 0; i < graph.degree(u); i++)
+        {
+            UInt32 v = graph.targets(u)[i];
+            if ( depth[v] == no_vertex)
+            {
+                depth[v] = depth[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return depth;
+}
+
+/** Whether the parents form a BFS tree of the graph with the given depths */
+static bool isBfsTree(const Graph<> &graph, const std::vector<UInt32> &parent, const std::vector<UInt32> &depth)
+{
+    for (UInt32 v = 0; v < graph.numVertices(); v++)
+    {
+        if ( (parent[v] == no_vertex) != (depth[v] == no_vertex)) return false;
+        if ( parent[v] == no_vertex || depth[v] == 0) continue;
+
+        UInt32 u = parent[v];
+        const UInt32 *targets = graph.targets(u);
+        if ( depth[u] + 1 != depth[v] || !std::binary_search(targets, targets + graph.degree(u), v)) return false;
+    }
+    return true;
+}
+
+/** Whether the edges join different components each time, i.e. form a forest */
+static bool isForest(UInt32 num_vertices, const Graph<>::EdgeList &edges)
+{
+    TreeUF<> uf(num_vertices);
+    for (const Graph<>::Edge &edge : edges)
+    {
+        if ( uf.areConnected(edge.from, edge.to)) return false;
+        uf.unite(edge.from, edge.to);
+    }
+    return true;
+}
+
+static UInt64 totalWeight(const Graph<>::EdgeList &edges)
+{
+    UInt64 sum = 0;
+    for (const Graph<>::Edge &edge : edges) sum += edge.weight;
+    return sum;
+}
+
+/**
+ * Unit test for the CSR graph and the graph algorithms
+ */
+bool Alg::uTestGraph(UnitTest *utest_p)
+{
+    const UInt32 inf = std::numeric_limits<UInt32>::max();
+
+    // Small graph of three components: 0-4, 5-6 and the isolated 7
+    {
+        Graph<>::EdgeList edges = { {0, 1, 4}, {0, 2, 1}, {2, 1, 2}, {1, 3, 5}, {2, 3, 8}, {3, 4, 3}, {5, 6, 1} };
+        Graph<> graph;
+        graph.build(8, edges);
+
+        UTEST_CHECK(utest_p, graph.numVertices() == 8 && graph.numArcs() == 14);
+        UTEST_CHECK(utest_p, graph.degree(2) == 3 && graph.degree(7) == 0);
+        UTEST_CHECK(utest_p, graph.targets(2)[0] == 0 && graph.targets(2)[1] == 1 && graph.targets(2)[2] == 3);
+        UTEST_CHECK(utest_p, graph.weights(2)[0] == 1 && graph.weights(2)[1] == 2 && graph.weights(2)[2] == 8);
+
+        Graph<> directed;
+        directed.build(8, edges, Directed);
+        Graph<> transposed = directed.transpose();
+        UTEST_CHECK(utest_p, directed.numArcs() == 7 && directed.degree(1) == 1 && directed.degree(4) == 0);
+        UTEST_CHECK(utest_p, transposed.degree(1) == 2 && transposed.targets(1)[0] == 0 && transposed.targets(1)[1] == 2);
+
+        Graph<>::EdgeList kruskal, prim;
+        kruskalMST(graph, kruskal);
+        primMST(graph, prim);
+        UTEST_CHECK(utest_p, kruskal.size() == 5 && totalWeight(kruskal) == 12);
+        UTEST_CHECK(utest_p, prim.size() == 5 && totalWeight(prim) == 12);
+
+        std::vector<UInt32> dist, parent;
+        dijkstra(graph, 0, dist, parent);
+        UInt32 expected_dist[] = { 0, 3, 1, 8, 11, inf, inf, inf };
+        UTEST_CHECK(utest_p, std::equal(dist.begin(), dist.end(), expected_dist));
+        UTEST_CHECK(utest_p, parent[0] == 0 && parent[1] == 2 && parent[3] == 1 && parent[6] == no_vertex);
+
+        bfs(graph, 0, parent);
+        UTEST_CHECK(utest_p, isBfsTree(graph, parent, bfsDepths(graph, 0)));
+        bfs(directed, transposed, 0, parent);
+        UTEST_CHECK(utest_p, isBfsTree(directed, parent, bfsDepths(directed, 0)));
+    }
+
+    // R-MAT graphs: the parallel build matches the sequential one, results are checked against the definitions
+    {
+        ThreadPool &pool = ThreadPool::instance();
+        ThreadPool::Config config;
+        config.num_threads = 4;
+        pool.configure(config);
+
+        const UInt32 scale = 12;
+        const UInt32 num_vertices = 1 << scale;
+        Xoshiro256 rng(17);
+        Graph<>::EdgeList edges;
+        rmatEdges<UInt32>(scale, 16 * num_vertices, 100, rng, edges);
+
+        Graph<> graph, graph_par;
+        graph.build(num_vertices, edges);
+        graph_par.build(execution::par, num_vertices, edges);
+        UTEST_CHECK(utest_p, graph.numArcs() == 2 * edges.size() && graph_par.numArcs() == graph.numArcs());
+
+        bool same = true, sorted = true;
+        for (UInt32 v = 0; v < num_vertices; v++)
+        {
+            UInt32 deg = graph.degree(v);
+            same = same && graph_par.degree(v) == deg
+                        && std::equal(graph.targets(v), graph.targets(v) + deg, graph_par.targets(v))
+                        && std::equal(graph.weights(v), graph.weights(v) + deg, graph_par.weights(v));
+            sorted = sorted && std::is_sorted(graph.targets(v), graph.targets(v) + deg);
+        }
+        UTEST_CHECK(utest_p, same && sorted);
+
+        // Both spanning forests have a tree per component and the same weight
+        TreeUF<> components(num_vertices);
+        UInt32 num_components = num_vertices;
+        for (const Graph<>::Edge &edge : edges)
+        {
+            if ( !components.areConnected(edge.from, edge.to)) num_components--;
+            components.unite(edge.from, edge.to);
+        }
+        Graph<>::EdgeList kruskal, prim;
+        kruskalMST(graph, kruskal);
+        primMST(graph, prim);
+        UTEST_CHECK(utest_p, kruskal.size() == num_vertices - num_components && prim.size() == kruskal.size());
+        UTEST_CHECK(utest_p, isForest(num_vertices, kruskal) && isForest(num_vertices, prim));
+        UTEST_CHECK(utest_p, totalWeight(kruskal) == totalWeight(prim));
+
+        // Shortest paths: no arc can shorten a path and every parent arc is tight
+        UInt32 source = edges.front().from;
+        std::vector<UInt32> dist, parent;
+        dijkstra(graph, source, dist, parent);
+        bool relaxed = true, tight = true;
+        for (UInt32 u = 0; u < num_vertices; u++)
+        {
+            if ( dist[u] == inf) continue;
+            for (UInt32 i = 0; i < graph.degree(u); i++)
+            {
+                UInt32 v = graph.targets(u)[i];
+                relaxed = relaxed && dist[v] <= dist[u] + graph.weights(u)[i];
+            }
+            if ( u != source)
+            {
+                UInt32 p = parent[u];
+                bool found = false;
+                for (UInt32 i = 0; i < graph.degree(p); i++)
+                {
+                    found = found || (graph.targets(p)[i] == u && dist[p] + graph.weights(p)[i] == dist[u]);
+                }
+                tight = tight && found;
+            }
+        }
+        UTEST_CHECK(utest_p, relaxed && tight);
+
+        // BFS reaches the same vertices as the shortest paths and builds a BFS tree
+        std::vector<UInt32> depth = bfsDepths(graph, source);
+        bfs(graph, source, parent);
+        UTEST_CHECK(utest_p, isBfsTree(graph, parent, depth));
+        bool same_reach = true;
+        for (UInt32 v = 0; v < num_vertices; v++) same_reach = same_reach && (depth[v] == no_vertex) == (dist[v] == inf);
+        UTEST_CHECK(utest_p, same_reach);
+
+        Graph<> directed, transposed;
+        directed.build(execution::par, num_vertices, edges, Directed);
+        transposed = directed.transpose();
+        bfs(directed, transposed, source, parent);
+        UTEST_CHECK(utest_p, isBfsTree(directed, parent, bfsDepths(directed, source)));
+
+        pool.configure( ThreadPool::Config());
+    }
+
+    return utest_p->result();
+}
@@ -1,5 +1,5 @@
 /**
-* @file: uf.h
+* @file: bin_search.h
 * Interface and implementation of binary serach algorithms library
 * @ingroup Algorithms
 * @brief Implementation of binary search algorithm after lectures by Robert Segewick
@@ -8,36 +8,75 @@
 * Algorithms library
 * Copyright (C) 2015  Boris Shurygin
 */
+#pragma once
+
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#if defined(__AVX2__) && defined(ALG_BINSEARCH_GATHER)
+#    include <immintrin.h>
+#endif
 
 namespace Alg
 {
     /**
-     * Binary search of element's iterator based on its value. Search is done between the 'from' and 'to' iterators
+     * Find the first element between the 'from' and 'to' iterators that is not less than the given value.
+     * Returns 'to' if there is no such element. The loop is branchless: the range is halved on every step
+     * and only the base moves, so the comparison result turns into a conditional move
      * @ingroup Algorithms
      */
     template <class Value, class RandomAccessIterator, class Compare = std::less<Value> >
-    typename RandomAccessIterator binSearch(const Value &val, RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less<Value>() )
+    RandomAccessIterator lowerBound(const Value &val, RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less<Value>())
     {
-        auto not_found = to;
-        while ( std::distance(from, to) >= 0)
+        auto len = std::distance(from, to);
+        if (len == 0) return to;
+
+        auto base = from;
+        while (len > 1)
         {
-            // middle element
-            auto mid = from + std::distance(from, to) / 2;
+            auto half = len / 2;
+            base = comp( *(base + half), val) ? base + half : base;
+            len -= half;
+        }
+        return comp( *base, val) ? base + 1 : base;
+    }
 
-            if ( comp( val, *mid) ) 
-            {
-                to = mid - 1;
-            } else if ( comp( *mid, val) )
-            {
-                from = mid + 1;
-            } else
-            {
-                return mid;
-            }
+    /**
+     * Find the first element between the 'from' and 'to' iterators that is greater than the given value.
+     * Returns 'to' if there is no such element
+     * @ingroup Algorithms
+     */
+    template <class Value, class RandomAccessIterator, class Compare = std::less<Value> >
+    RandomAccessIterator upperBound(const Value &val, RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less<Value>())
+    {
+        auto len = std::distance(from, to);
+        if (len == 0) return to;
+
+        auto base = from;
+        while (len > 1)
+        {
+            auto half = len / 2;
+            base = !comp( val, *(base + half)) ? base + half : base;
+            len -= half;
         }
-        return not_found;
+        return !comp( val, *base) ? base + 1 : base;
+    }
+
+    /**
+     * Binary search of element's iterator based on its value. Search is done between the 'from' and 'to' iterators.
+     * Returns the first element equal to the value or 'to' if there is none
+     * @ingroup Algorithms
+     */
+    template <class Value, class RandomAccessIterator, class Compare = std::less<Value> >
+    RandomAccessIterator binSearch(const Value &val, RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less<Value>() )
+    {
+        auto pos = lowerBound(val, from, to, comp);
+
+        if ( pos != to && !comp( val, *pos) ) return pos;
+        return to;
     }
 
     /**
@@ -50,5 +89,282 @@ namespace Alg
         return binSearch(val, data.begin(), data.end(), comp);
     }
 
+    /**
+     * Returns iterator to the first element of the container not less than the value
+     * @ingroup Algorithms
+     */
+    template <class Value, class Container, class Compare = std::less<Value> >
+    typename Container::iterator lowerBound(const Value &val, Container &data, Compare comp = std::less<Value>())
+    {
+        return lowerBound(val, data.begin(), data.end(), comp);
+    }
+
+    /**
+     * Returns iterator to the first element of the container greater than the value
+     * @ingroup Algorithms
+     */
+    template <class Value, class Container, class Compare = std::less<Value> >
+    typename Container::iterator upperBound(const Value &val, Container &data, Compare comp = std::less<Value>())
+    {
+        return upperBound(val, data.begin(), data.end(), comp);
+    }
+
+    /* Helper routines for batched binary search */
+    namespace BinSearch
+    {
+        /** Number of searches that run in lockstep */
+        const size_t batch_width = 16;
+
+        /**
+         * Lower bound positions of the queries [first, last) in the sorted data. All searches of the batch
+         * have the same remaining length on every step, so they advance together: each step issues the
+         * independent loads of all searches and prefetches both candidates of their next probes
+         */
+        template <class Value, class T, class Compare>
+        void lowerBoundGroup(const Value *queries, size_t num, const T *data, size_t size,
+                             size_t *results, Compare &comp)
+        {
+            size_t base[batch_width] = { 0 };
+
+            size_t len = size;
+            while (len > 1)
+            {
+                size_t half = len / 2;
+                size_t next_half = (len - half) / 2;
+
+                for (size_t i = 0; i < num; i++)
+                {
+                    ALG_PREFETCH(data + base[i] + next_half);
+                    ALG_PREFETCH(data + base[i] + half + next_half);
+                    base[i] = comp( data[base[i] + half], queries[i]) ? base[i] + half : base[i];
+                }
+                len -= half;
+            }
+            for (size_t i = 0; i < num; i++)
+            {
+                results[i] = base[i] + (comp( data[base[i]], queries[i]) ? 1 : 0);
+            }
+        }
+
+#if defined(__AVX2__) && defined(ALG_BINSEARCH_GATHER)
+        /** Unsigned 32-bit 'a < b' for each lane */
+        inline __m256i lessU32(__m256i a, __m256i b)
+        {
+            const __m256i sign = _mm256_set1_epi32(0x80000000);
+            return _mm256_cmpgt_epi32( _mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+        }
+
+        /**
+         * AVX2 version of the lockstep search for 32-bit unsigned keys: two vectors of 8 searches advance together,
+         * probes are gathered and the candidates of the next probes are prefetched lane by lane
+         */
+        inline void lowerBoundGroupAVX2(const UInt32 *queries, size_t num, const UInt32 *data, size_t size,
+                                        size_t *results)
+        {
+            const size_t lanes = 8;
+            const int *idata = reinterpret_cast<const int *>(data);
+
+            size_t i = 0;
+            for (; i + 2 * lanes <= num; i += 2 * lanes)
+            {
+                __m256i q0 = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(queries + i));
+                __m256i q1 = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(queries + i + lanes));
+                __m256i base0 = _mm256_setzero_si256();
+                __m256i base1 = _mm256_setzero_si256();
+                alignas(32) UInt32 pos[2 * lanes];
+
+                size_t len = size;
+                while (len > 1)
+                {
+                    size_t half = len / 2;
+                    size_t next_half = (len - half) / 2;
+
+                    _mm256_store_si256( reinterpret_cast<__m256i *>(pos), base0);
+                    _mm256_store_si256( reinterpret_cast<__m256i *>(pos + lanes), base1);
+                    for (size_t j = 0; j < 2 * lanes; j++)
+                    {
+                        ALG_PREFETCH(data + pos[j] + next_half);
+                        ALG_PREFETCH(data + pos[j] + half + next_half);
+                    }
+
+                    // base += half where data[base + half] < query
+                    __m256i step = _mm256_set1_epi32( static_cast<int>(half));
+                    __m256i probe_pos0 = _mm256_add_epi32(base0, step);
+                    __m256i probe_pos1 = _mm256_add_epi32(base1, step);
+                    __m256i probe0 = _mm256_i32gather_epi32(idata, probe_pos0, 4);
+                    __m256i probe1 = _mm256_i32gather_epi32(idata, probe_pos1, 4);
+                    base0 = _mm256_blendv_epi8(base0, probe_pos0, lessU32(probe0, q0));
+                    base1 = _mm256_blendv_epi8(base1, probe_pos1, lessU32(probe1, q1));
+                    len -= half;
+                }
+
+                // Mask is -1 in the lanes that need +1
+                base0 = _mm256_sub_epi32(base0, lessU32( _mm256_i32gather_epi32(idata, base0, 4), q0));
+                base1 = _mm256_sub_epi32(base1, lessU32( _mm256_i32gather_epi32(idata, base1, 4), q1));
+
+                _mm256_store_si256( reinterpret_cast<__m256i *>(pos), base0);
+                _mm256_store_si256( reinterpret_cast<__m256i *>(pos + lanes), base1);
+                for (size_t j = 0; j < 2 * lanes; j++) results[i + j] = pos[j];
+            }
+
+            // The tail goes through the scalar version
+            if (i < num)
+            {
+                std::less<UInt32> comp;
+                lowerBoundGroup(queries + i, num - i, data, size, results + i, comp);
+            }
+        }
+#endif
+
+        /** Generic batch: scalar lockstep searches */
+        template <class Value, class T, class Compare>
+        void lowerBoundBatch(const Value *queries, size_t num, const T *data, size_t size,
+                             size_t *results, Compare &comp, std::false_type use_gather)
+        {
+            for (size_t i = 0; i < num; i += batch_width)
+            {
+                lowerBoundGroup(queries + i, std::min(batch_width, num - i), data, size, results + i, comp);
+            }
+        }
+
+        /** 32-bit unsigned keys in ascending order: gather-based searches if they are enabled at compile time */
+        template <class Value, class T, class Compare>
+        void lowerBoundBatch(const Value *queries, size_t num, const T *data, size_t size,
+                             size_t *results, Compare &comp, std::true_type use_gather)
+        {
+#if defined(__AVX2__) && defined(ALG_BINSEARCH_GATHER)
+            if ( size < (size_t(1) << 31))
+            {
+                for (size_t i = 0; i < num; i += batch_width)
+                {
+                    lowerBoundGroupAVX2(queries + i, std::min(batch_width, num - i), data, size, results + i);
+                }
+                return;
+            }
+#endif
+            lowerBoundBatch(queries, num, data, size, results, comp, std::false_type());
+        }
+
+        /** Replace the lower bounds results[first, last) that are not equal to their queries by data.size() */
+        template <class QueryContainer, class Container, class Compare>
+        void keepMatches(const QueryContainer &queries, const Container &data, std::vector<size_t> &results,
+                         size_t first, size_t last, Compare &comp)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                if ( results[i] == data.size() || comp( queries[i], data[results[i]]) )
+                {
+                    results[i] = data.size();
+                }
+            }
+        }
+
+        /** Whether the batch can use 32-bit gathers */
+        template <class Value, class T, class Compare> struct UseGather
+        {
+            static const bool value = std::is_same<Value, UInt32>::value
+                                      && std::is_same<T, UInt32>::value
+                                      && std::is_same<Compare, std::less<UInt32> >::value;
+        };
+    } /* namespace BinSearch */
+
+    /**
+     * Lower bound search of many values at once. results[i] receives the position of the first element
+     * of the sorted container not less than queries[i] (data.size() if there is no such element).
+     * Searches run in lockstep groups with branchless updates and software prefetch of the next probes.
+     * Building with AVX2 and ALG_BINSEARCH_GATHER defined searches 32-bit unsigned keys by vector gathers;
+     * it is off by default since the scalar lockstep loop keeps more loads in flight on the CPUs we measured
+     * @ingroup Algorithms
+     */
+    template <class QueryContainer, class Container,
+              class Compare = std::less<typename QueryContainer::value_type> >
+    void lowerBoundBatch(const QueryContainer &queries, const Container &data, std::vector<size_t> &results,
+                         Compare comp = Compare())
+    {
+        typedef typename QueryContainer::value_type Value;
+        typedef typename Container::value_type T;
+
+        results.resize( queries.size());
+        if ( queries.empty()) return;
+
+        if ( data.empty())
+        {
+            std::fill(results.begin(), results.end(), 0);
+            return;
+        }
+        BinSearch::lowerBoundBatch(queries.data(), queries.size(), data.data(), data.size(), results.data(), comp,
+                                   std::integral_constant<bool, BinSearch::UseGather<Value, T, Compare>::value>());
+    }
+
+    /**
+     * Binary search of many values at once. results[i] receives the position of the first element
+     * equal to queries[i] or data.size() if there is none. See lowerBoundBatch
+     * @ingroup Algorithms
+     */
+    template <class QueryContainer, class Container,
+              class Compare = std::less<typename QueryContainer::value_type> >
+    void binSearchBatch(const QueryContainer &queries, const Container &data, std::vector<size_t> &results,
+                        Compare comp = Compare())
+    {
+        lowerBoundBatch(queries, data, results, comp);
+        BinSearch::keepMatches(queries, data, results, 0, results.size(), comp);
+    }
+
+    /**
+     * Lower bound search of many values at once under the execution policy. The parallel policies
+     * split the queries into blocks searched on the shared ThreadPool. See lowerBoundBatch
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class QueryContainer, class Container,
+              class Compare = std::less<typename QueryContainer::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    lowerBoundBatch(const ExecutionPolicy &policy, const QueryContainer &queries, const Container &data,
+                    std::vector<size_t> &results, Compare comp = Compare())
+    {
+        typedef typename QueryContainer::value_type Value;
+        typedef typename Container::value_type T;
+
+        size_t num = queries.size();
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value || num < 2 * Parallel::search_block || data.empty())
+        {
+            lowerBoundBatch(queries, data, results, comp);
+            return;
+        }
+
+        results.resize(num);
+        ThreadPool::instance().parallelFor( (num + Parallel::search_block - 1) / Parallel::search_block, [&](size_t i)
+        {
+            size_t first = i * Parallel::search_block;
+            BinSearch::lowerBoundBatch(queries.data() + first, std::min(Parallel::search_block, num - first),
+                                       data.data(), data.size(), results.data() + first, comp,
+                                       std::integral_constant<bool, BinSearch::UseGather<Value, T, Compare>::value>());
+        });
+    }
+
+    /**
+     * Binary search of many values at once under the execution policy. See binSearchBatch
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class QueryContainer, class Container,
+              class Compare = std::less<typename QueryContainer::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    binSearchBatch(const ExecutionPolicy &policy, const QueryContainer &queries, const Container &data,
+                   std::vector<size_t> &results, Compare comp = Compare())
+    {
+        size_t num = queries.size();
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value || num < 2 * Parallel::search_block)
+        {
+            binSearchBatch(queries, data, results, comp);
+            return;
+        }
+
+        lowerBoundBatch(policy, queries, data, results, comp);
+        ThreadPool::instance().parallelFor( (num + Parallel::search_block - 1) / Parallel::search_block, [&](size_t i)
+        {
+            size_t first = i * Parallel::search_block;
+            BinSearch::keepMatches(queries, data, results, first, std::min(num, first + Parallel::search_block), comp);
+        });
+    }
+
     bool uTestBinSearch(UnitTest *utest_p);
-}
\ No newline at end of file
+}
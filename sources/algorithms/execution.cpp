@@ -0,0 +1,236 @@
+/**
+* @file: execution.cpp
+* Implementation of the shared work-stealing thread pool
+*/
+/*
+* Copyright (C) 2015  Boris Shurygin
+*/
+#include "alg_iface.h"
+
+#include <cstdlib>
+
+#if defined(__linux__)
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace Alg
+{
+    /* Pool and queue of the calling thread if it is a worker */
+    static thread_local const ThreadPool *current_pool = nullptr;
+    static thread_local size_t current_index = 0;
+
+    ThreadPool &ThreadPool::instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ThreadPool::ThreadPool(const Config &config):
+        queued(0), stopping(false)
+    {
+        start(config);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        stop();
+    }
+
+    void ThreadPool::configure(const Config &config)
+    {
+        stop();
+        start(config);
+    }
+
+    unsigned ThreadPool::numThreads() const
+    {
+        return static_cast<unsigned>( workers.size()) + 1;
+    }
+
+    void ThreadPool::start(const Config &config)
+    {
+        unsigned num_threads = config.num_threads;
+        if ( num_threads == 0)
+        {
+            const char *env = std::getenv("ALG_NUM_THREADS");
+            if ( env) num_threads = static_cast<unsigned>( std::strtoul(env, nullptr, 10));
+        }
+        if ( num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        stopping = false;
+        for (unsigned i = 0; i < num_threads; i++) queues.emplace_back( new Queue());
+        for (unsigned i = 1; i < num_threads; i++)
+        {
+            workers.emplace_back( &ThreadPool::workerLoop, this, i);
+#if defined(__linux__)
+            if ( !config.cpus.empty())
+            {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(config.cpus[(i - 1) % config.cpus.size()], &cpus);
+                pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus);
+            }
+#endif
+        }
+    }
+
+    void ThreadPool::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers) worker.join();
+
+        workers.clear();
+        queues.clear();
+    }
+
+    void ThreadPool::workerLoop(size_t index)
+    {
+        current_pool = this;
+        current_index = index;
+
+        while (true)
+        {
+            if ( runOne(index)) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_lock);
+            wake.wait(lock, [this]() { return stopping || queued > 0; });
+            if ( stopping && queued <= 0) return;
+        }
+    }
+
+    size_t ThreadPool::currentIndex() const
+    {
+        return current_pool == this ? current_index : 0;
+    }
+
+    void ThreadPool::submit(Job job)
+    {
+        Queue &queue = *queues[currentIndex()];
+        {
+            std::lock_guard<std::mutex> lock(queue.lock);
+            queue.jobs.push_back( std::move(job));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    bool ThreadPool::runOne(size_t index)
+    {
+        Job job;
+        bool found = false;
+
+        // Own tasks are taken newest first, the others' tasks are stolen oldest first
+        for (size_t i = 0; i < queues.size() && !found; i++)
+        {
+            Queue &queue = *queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.lock);
+            if ( queue.jobs.empty()) continue;
+
+            if ( i == 0)
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            } else
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+            found = true;
+        }
+        if ( !found) return false;
+
+        queued--;
+        std::exception_ptr error;
+        try
+        {
+            job.fn();
+        } catch (...)
+        {
+            error = std::current_exception();
+        }
+        job.group->finish(error);
+        return true;
+    }
+
+    TaskGroup::TaskGroup(ThreadPool &p):
+        pool(p), pending(0)
+    {
+
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        join();
+    }
+
+    void TaskGroup::run(std::function<void()> task)
+    {
+        if ( pool.workers.empty())
+        {
+            // No workers: the task runs right away
+            try
+            {
+                task();
+            } catch (...)
+            {
+                fail( std::current_exception());
+            }
+            return;
+        }
+
+        pending++;
+        ThreadPool::Job job = { std::move(task), this };
+        pool.submit( std::move(job));
+    }
+
+    void TaskGroup::join()
+    {
+        // Help with the pending tasks, sleep when all of them are taken by other threads
+        size_t index = pool.currentIndex();
+        while (pending > 0)
+        {
+            if ( pool.runOne(index)) continue;
+
+            std::unique_lock<std::mutex> lock(done_lock);
+            done.wait(lock, [this]() { return pending == 0; });
+        }
+
+        // The last finish() may still hold the lock
+        std::lock_guard<std::mutex> lock(done_lock);
+    }
+
+    void TaskGroup::wait()
+    {
+        join();
+
+        std::exception_ptr err;
+        {
+            std::lock_guard<std::mutex> lock(error_lock);
+            std::swap(err, error);
+        }
+        if ( err) std::rethrow_exception(err);
+    }
+
+    void TaskGroup::fail(std::exception_ptr err)
+    {
+        std::lock_guard<std::mutex> lock(error_lock);
+        if ( !error) error = err;
+    }
+
+    void TaskGroup::finish(std::exception_ptr err)
+    {
+        if ( err) fail(err);
+
+        // The lock is held until the end: the waiting thread may destroy the group right after it
+        std::lock_guard<std::mutex> lock(done_lock);
+        if ( --pending == 0) done.notify_all();
+    }
+}
@@ -0,0 +1,328 @@
+/**
+* @file: execution.h
+* Interface of the execution policies and of the shared thread pool
+* @ingroup Algorithms
+* @brief Execution policies seq/par/par_unseq, work-stealing thread pool and parallel merging helpers
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+namespace Alg
+{
+    /**
+     * Execution policies. Algorithms with a policy overload take one of the policy objects as the first
+     * argument: seq runs the sequential code, par runs on the shared ThreadPool. par_unseq allows
+     * vectorization on top of par; the library vectorizes the same way under both, so it runs as par
+     * @ingroup Algorithms
+     */
+    namespace execution
+    {
+        struct SequencedPolicy {};
+        struct ParallelPolicy {};
+        struct ParallelUnsequencedPolicy {};
+
+        const SequencedPolicy seq = SequencedPolicy();
+        const ParallelPolicy par = ParallelPolicy();
+        const ParallelUnsequencedPolicy par_unseq = ParallelUnsequencedPolicy();
+
+        template <class T> struct IsExecutionPolicy: std::false_type {};
+        template <> struct IsExecutionPolicy<SequencedPolicy>: std::true_type {};
+        template <> struct IsExecutionPolicy<ParallelPolicy>: std::true_type {};
+        template <> struct IsExecutionPolicy<ParallelUnsequencedPolicy>: std::true_type {};
+
+        /** Whether the policy allows running on several threads */
+        template <class T> struct IsParallelPolicy: std::false_type {};
+        template <> struct IsParallelPolicy<ParallelPolicy>: std::true_type {};
+        template <> struct IsParallelPolicy<ParallelUnsequencedPolicy>: std::true_type {};
+
+        /** Return type of the policy overloads, keeps them out of the overload set for non-policy arguments */
+        template <class Policy, class R = void>
+        struct EnableIfPolicy: std::enable_if< IsExecutionPolicy<Policy>::value, R> {};
+    } /* namespace execution */
+
+    class TaskGroup;
+
+    /**
+     * Work-stealing thread pool shared by the parallel algorithms. Each worker has its own task deque: it runs
+     * its own tasks newest first and steals the oldest tasks of the others when it runs out. A thread waiting
+     * for a TaskGroup runs the pending tasks instead of blocking, so parallel algorithms can nest.
+     * The number of threads of the shared pool is taken from the ALG_NUM_THREADS environment variable,
+     * all hardware threads by default, and can be changed by configure()
+     * @ingroup Algorithms
+     */
+    class ThreadPool
+    {
+    public:
+        struct Config
+        {
+            unsigned num_threads;      /**< Threads including the calling one, 0 for the default */
+            std::vector<unsigned> cpus; /**< CPUs the workers are pinned to round-robin, none if empty */
+
+            Config(): num_threads(0){}
+        };
+
+        static ThreadPool &instance(); /**< The shared pool */
+
+        explicit ThreadPool(const Config &config = Config());
+        ~ThreadPool();
+
+        /** Restart the workers with a new configuration. Must not be called while the pool runs tasks */
+        void configure(const Config &config);
+
+        unsigned numThreads() const; /**< Workers and the calling thread */
+
+        /** Run task(i) for i in [0, num_tasks) and wait for all of them, indices are handed out dynamically */
+        template <class Task> void parallelFor(size_t num_tasks, Task task);
+
+    private:
+        friend class TaskGroup;
+
+        ThreadPool(const ThreadPool &);
+        ThreadPool &operator=(const ThreadPool &);
+
+        struct Job
+        {
+            std::function<void()> fn;
+            TaskGroup *group;
+        };
+
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<Job> jobs;
+        };
+
+        void start(const Config &config);
+        void stop();
+        void workerLoop(size_t index);
+
+        void submit(Job job);
+        bool runOne(size_t index);  /**< Run one pending task, false if there is none */
+        size_t currentIndex() const; /**< Queue of the calling thread, 0 for the threads outside of the pool */
+
+        std::vector<std::thread> workers;
+        std::vector< std::unique_ptr<Queue> > queues; // Queue 0 takes the tasks of the outside threads
+
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+        std::atomic<long> queued;
+        bool stopping;
+    };
+
+    /**
+     * Group of tasks run on a pool. wait() returns when all the tasks of the group are done and rethrows
+     * the first exception thrown by them. The destructor waits too
+     * @ingroup Algorithms
+     */
+    class TaskGroup
+    {
+    public:
+        explicit TaskGroup(ThreadPool &p = ThreadPool::instance());
+        ~TaskGroup();
+
+        void run(std::function<void()> task); /**< Start a task  */
+        void wait();                           /**< Wait for the tasks of the group */
+
+    private:
+        friend class ThreadPool;
+
+        TaskGroup(const TaskGroup &);
+        TaskGroup &operator=(const TaskGroup &);
+
+        void fail(std::exception_ptr err);   /**< Keep the first exception of the tasks      */
+        void finish(std::exception_ptr err); /**< Called by the pool when a task is done */
+        void join();
+
+        ThreadPool &pool;
+        std::atomic<size_t> pending;
+        std::mutex done_lock;
+        std::condition_variable done;
+        std::mutex error_lock;
+        std::exception_ptr error;
+    };
+
+    template <class Task>
+    void ThreadPool::parallelFor(size_t num_tasks, Task task)
+    {
+        if ( num_tasks == 0) return;
+        if ( num_tasks == 1 || workers.empty())
+        {
+            for (size_t i = 0; i < num_tasks; i++) task(i);
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        auto runner = [&]()
+        {
+            for (size_t i = next++; i < num_tasks; i = next++) task(i);
+        };
+
+        TaskGroup group(*this);
+        size_t num_runners = std::min<size_t>(num_tasks, numThreads());
+        for (size_t r = 1; r < num_runners; r++) group.run(runner);
+
+        try
+        {
+            runner();
+        } catch (...)
+        {
+            next = num_tasks; // the other runners stop, the group destructor waits for them
+            throw;
+        }
+        group.wait();
+    }
+
+    /* Building blocks of the parallel algorithms */
+    namespace Parallel
+    {
+        const size_t merge_block = 1 << 14;    // Output elements merged by one task
+        const size_t min_sort_chunk = 1 << 13; // Smallest chunk sorted by one task
+        const size_t search_block = 1 << 12;   // Queries of a batch searched by one task
+
+        /**
+         * Number of the elements of the first sequence among the first k elements of the stable merge
+         * of [first1, first1 + size1) and [first2, first2 + size2)
+         */
+        template <class Iterator1, class Iterator2, class Compare>
+        size_t coRank(size_t k, Iterator1 first1, size_t size1, Iterator2 first2, size_t size2, Compare &comp)
+        {
+            size_t lo = k > size2 ? k - size2 : 0;
+            size_t hi = std::min(k, size1);
+
+            while (lo < hi)
+            {
+                size_t i = lo + (hi - lo) / 2;
+
+                // first1[i] precedes first2[k - i - 1] in the merge: more elements of the first sequence are needed
+                if ( !comp( first2[k - i - 1], first1[i]) ) lo = i + 1;
+                else hi = i;
+            }
+            return lo;
+        }
+
+        /** Elements [k, k + len) of the stable merge of the two sequences, written to dst + k */
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        void mergeBlock(Iterator1 first1, size_t size1, Iterator2 first2, size_t size2, OutputIterator dst,
+                        size_t k, size_t len, Compare comp)
+        {
+            size_t i = coRank(k, first1, size1, first2, size2, comp);
+
+            Iterator1 from1 = first1 + i, to1 = first1 + size1;
+            Iterator2 from2 = first2 + (k - i), to2 = first2 + size2;
+            OutputIterator out = dst + k;
+
+            for (size_t n = 0; n < len; n++)
+            {
+                // Equal elements are taken from the first sequence to keep the merge stable
+                if ( from2 != to2 && (from1 == to1 || comp(*from2, *from1)) ) *out++ = *from2++;
+                else *out++ = *from1++;
+            }
+        }
+
+        /** Stable merge of the two sequences into dst, blocks of the output are merged in parallel */
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        void merge(Iterator1 first1, size_t size1, Iterator2 first2, size_t size2, OutputIterator dst,
+                   Compare comp, ThreadPool &pool)
+        {
+            size_t size = size1 + size2;
+            size_t num_blocks = (size + merge_block - 1) / merge_block;
+
+            pool.parallelFor(num_blocks, [&](size_t i)
+            {
+                size_t k = i * merge_block;
+                mergeBlock(first1, size1, first2, size2, dst, k, std::min(merge_block, size - k), comp);
+            });
+        }
+
+        /** Merge of the adjacent pairs of sorted runs 'width' runs wide from src into dst */
+        template <class SrcIterator, class DstIterator, class Compare>
+        void mergeLevel(SrcIterator src, DstIterator dst, const std::vector<size_t> &bounds, size_t width,
+                        Compare &comp, ThreadPool &pool)
+        {
+            struct Block { size_t from, middle, to, k; };
+
+            std::vector<Block> blocks;
+            size_t num_runs = bounds.size() - 1;
+            for (size_t run = 0; run < num_runs; run += 2 * width)
+            {
+                Block block = { bounds[run], bounds[std::min(run + width, num_runs)],
+                                bounds[std::min(run + 2 * width, num_runs)], 0 };
+                for (block.k = 0; block.k < block.to - block.from; block.k += merge_block) blocks.push_back(block);
+            }
+
+            pool.parallelFor(blocks.size(), [&](size_t i)
+            {
+                const Block &b = blocks[i];
+                mergeBlock(std::make_move_iterator(src + b.from), b.middle - b.from,
+                           std::make_move_iterator(src + b.middle), b.to - b.middle,
+                           dst + b.from, b.k, std::min(merge_block, b.to - b.from - b.k), comp);
+            });
+        }
+
+        /**
+         * Parallel sort: chunks of the sequence are sorted by 'chunk_sort' on the pool threads, then merged
+         * level by level with parallel stable merges. Stable if 'chunk_sort' is stable
+         */
+        template <class RandomAccessIterator, class Compare, class ChunkSort>
+        void sortMerge(RandomAccessIterator from, RandomAccessIterator to, Compare comp, ChunkSort chunk_sort)
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+            ThreadPool &pool = ThreadPool::instance();
+
+            size_t size = std::distance(from, to);
+            size_t num_chunks = 1;
+            while (num_chunks < 4 * pool.numThreads() && size / (2 * num_chunks) >= min_sort_chunk) num_chunks *= 2;
+
+            if ( num_chunks == 1 || pool.numThreads() == 1)
+            {
+                chunk_sort(from, to);
+                return;
+            }
+
+            std::vector<size_t> bounds(num_chunks + 1);
+            for (size_t i = 0; i <= num_chunks; i++) bounds[i] = (size * i) / num_chunks;
+
+            pool.parallelFor(num_chunks, [&](size_t i)
+            {
+                chunk_sort(from + bounds[i], from + bounds[i + 1]);
+            });
+
+            // Runs are merged back and forth between the sequence and the buffer
+            std::vector<T> buf(size);
+            bool in_buf = false;
+            for (size_t width = 1; width < num_chunks; width *= 2)
+            {
+                if ( in_buf) mergeLevel(buf.begin(), from, bounds, width, comp, pool);
+                else mergeLevel(from, buf.begin(), bounds, width, comp, pool);
+                in_buf = !in_buf;
+            }
+
+            if ( in_buf)
+            {
+                pool.parallelFor(num_chunks, [&](size_t i)
+                {
+                    std::move(buf.begin() + bounds[i], buf.begin() + bounds[i + 1], from + bounds[i]);
+                });
+            }
+        }
+    } /* namespace Parallel */
+
+    bool uTestExecution(UnitTest *utest_p);
+
+} /* namespace Alg */
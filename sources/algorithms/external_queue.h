@@ -0,0 +1,404 @@
+/**
+* @file: external_queue.h
+* Interface and implementation of the external memory priority queue
+* @ingroup Algorithms
+* @brief Priority queue that keeps a bounded part of its elements in memory and spills sorted runs to files
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <stdio.h>
+#    include <unistd.h>
+#elif defined(_WIN32)
+#    include <process.h>
+#endif
+
+namespace Alg
+{
+    /* Helper routines of the external memory priority queue */
+    namespace External
+    {
+        const size_t fan_in = 16;    // Number of the runs of a level that are merged into one run of the next level
+        const size_t max_levels = 4; // The read buffers are sized so that this many full levels fit in the budget
+
+        /**
+         * Open a file for a run: a temporary file if the directory is empty, a new file in the directory otherwise.
+         * The new file gets a unique name (mkstemp) and is created exclusively, so queues of different threads
+         * and processes may share the directory
+         */
+        inline std::FILE *openRunFile(const std::string &dir, std::string &path)
+        {
+            std::FILE *file = nullptr;
+            if ( dir.empty())
+            {
+                file = std::tmpfile();
+            } else
+            {
+#if defined(__unix__) || defined(__APPLE__)
+                std::string name = dir + "/alg_queue_XXXXXX";
+                int fd = mkstemp(&name[0]);
+                if ( fd >= 0)
+                {
+                    path = name;
+                    file = fdopen(fd, "w+b");
+                    if ( !file)
+                    {
+                        close(fd);
+                        std::remove(path.c_str());
+                    }
+                }
+#else
+                static std::atomic<unsigned long long> counter(0);
+#    if defined(_WIN32)
+                unsigned long long pid = _getpid();
+#    else
+                unsigned long long pid = 0;
+#    endif
+                path = dir + "/alg_queue_" + std::to_string(pid) + "_" + std::to_string(counter++) + ".run";
+                file = std::fopen(path.c_str(), "w+bx"); // Fails instead of truncating an existing file
+#endif
+            }
+            if ( !file) throw std::runtime_error("ExternalPriorityQueue: cannot create a run file");
+            return file;
+        }
+
+        /**
+         * Sorted run in a file, greatest element first by the queue order. The elements are read back in
+         * blocks, the current block is kept in the buffer
+         */
+        template <class T> class Run
+        {
+        public:
+            Run(const std::string &dir): file(nullptr), written(0), unread(0), pos(0)
+            {
+                file = openRunFile(dir, path);
+            }
+            ~Run()
+            {
+                std::fclose(file);
+                if ( !path.empty()) std::remove(path.c_str());
+            }
+
+            /** Append the elements to the file */
+            void write(const T *data, size_t count)
+            {
+                if ( std::fwrite(data, sizeof(T), count, file) != count)
+                {
+                    throw std::runtime_error("ExternalPriorityQueue: cannot write a run file");
+                }
+                written += count;
+            }
+
+            /** Done writing: read the first block into a buffer of the given size */
+            void start(size_t block)
+            {
+                if ( std::fflush(file) != 0 || std::fseek(file, 0, SEEK_SET) != 0)
+                {
+                    throw std::runtime_error("ExternalPriorityQueue: cannot rewind a run file");
+                }
+                unread = written;
+                buffer.reserve( static_cast<size_t>( std::min<UInt64>(block, written)));
+                fill();
+            }
+
+            const T &head() const { return buffer[pos]; }           /**< Current element                */
+            bool empty() const { return pos == buffer.size(); }    /**< Whether all the elements are taken */
+            UInt64 size() const { return unread + buffer.size() - pos; } /**< Number of the elements left */
+
+            /** Move to the next element, reads the next block when the buffer is consumed */
+            void next()
+            {
+                if ( ++pos == buffer.size() && unread != 0) fill();
+            }
+
+        private:
+            Run(const Run &);
+            Run &operator=(const Run &);
+
+            void fill()
+            {
+                size_t count = static_cast<size_t>( std::min<UInt64>(buffer.capacity(), unread));
+                buffer.resize(count);
+                if ( std::fread(buffer.data(), sizeof(T), count, file) != count)
+                {
+                    throw std::runtime_error("ExternalPriorityQueue: cannot read a run file");
+                }
+                unread -= count;
+                pos = 0;
+            }
+
+            std::FILE *file;
+            std::string path;     // Empty for a temporary file, which is removed by the system
+            UInt64 written;
+            UInt64 unread;        // Elements in the file after the buffer
+            std::vector<T> buffer;
+            size_t pos;
+        };
+
+        /** Current element of a run in the merge heap */
+        template <class T> struct Head
+        {
+            T value;
+            Run<T> *run;
+        };
+
+        /** Order of the heads by their values */
+        template <class T, class Compare> struct HeadLess
+        {
+            bool operator()(const Head<T> &a, const Head<T> &b) const { return Compare()(a.value, b.value); }
+        };
+    } /* namespace External */
+
+    /**
+     * Priority queue for the element counts that do not fit in memory (a simplified sequence heap after
+     * P. Sanders). New elements go to an insertion heap in memory; when it is full, it is sorted and written
+     * to a file as one run with a single sequential write. Runs are kept in levels: when a level collects
+     * External::fan_in runs, they are merged into one run of the next level, so each element is rewritten
+     * O(log(n / m) / log(fan_in)) times. The greatest heads of the runs are merged lazily by a heap of the
+     * run heads, each run being read back in blocks.
+     *
+     * Half of the memory budget (in bytes) goes to the insertion heap, the other half to the read buffers
+     * of the runs. The order is the same as in PriorityQueue: top() is the greatest element by Compare.
+     * The elements are written to the files as raw bytes, so T must be trivially copyable. Run files are
+     * temporary files of the system unless a directory is given; I/O errors throw std::runtime_error, after
+     * that the queue holds no dangling state but may have lost elements, so it is only fit for clear()
+     * @ingroup Algorithms
+     */
+    template <class T, class Compare = std::less<T> > class ExternalPriorityQueue
+    {
+        static_assert( std::is_trivially_copyable<T>::value, "ExternalPriorityQueue stores the elements as raw bytes");
+    public:
+        typedef UInt64 size_type;
+
+        explicit ExternalPriorityQueue(size_t memory_budget = 64 * 1024 * 1024,
+                                       const std::string &dir = std::string()); /**< Constructor */
+
+        void pop();                /**< Remove the top element */
+        void push(const T& val);   /**< Insert element         */
+        const T& top() const;      /**< Access the top element */
+
+        size_type size() const;    /**< Get the size of the queue   */
+        bool empty() const;        /**< Check if the queue is empty */
+
+        void clear();              /**< Remove all the elements and the run files */
+
+        size_t numRuns() const;    /**< Number of the runs in the files */
+
+    private:
+        typedef External::Run<T> Run;
+        typedef External::Head<T> Head;
+        typedef PriorityQueue<Head, std::allocator<Head>, External::HeadLess<T, Compare> > Merger;
+
+        void spill();                            /**< Write the insertion heap to a new run */
+        void addRun(std::unique_ptr<Run> run, size_t level);
+        void mergeLevel(size_t level);           /**< Merge the runs of a level into a run of the next one */
+        void rebuildMerger();
+        bool fromRuns() const;                   /**< Whether the top element is in a run */
+
+        size_t heap_capacity; // Elements of the insertion heap
+        size_t block;         // Elements of the read buffer of a run
+        std::string dir;
+
+        std::vector<T> heap;  // Insertion heap, arranged by std::push_heap/std::pop_heap
+        std::vector<std::vector<std::unique_ptr<Run> > > levels;
+        Merger merger;        // Heads of the non-empty runs
+        size_type count;
+    };
+
+    template <class T, class Compare>
+    ExternalPriorityQueue<T, Compare>::ExternalPriorityQueue(size_t memory_budget, const std::string &d):
+        heap_capacity( std::max<size_t>(memory_budget / 2 / sizeof(T), 1)),
+        block( std::max<size_t>(memory_budget / 2 / sizeof(T) / (External::fan_in * External::max_levels), 1)),
+        dir(d),
+        count(0)
+    {
+        heap.reserve(heap_capacity);
+    }
+
+    template <class T, class Compare>
+    bool ExternalPriorityQueue<T, Compare>::fromRuns() const
+    {
+        if ( merger.empty()) return false;
+        return heap.empty() || Compare()(heap.front(), merger.top().value);
+    }
+
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::push(const T &val)
+    {
+        if ( heap.size() == heap_capacity) spill();
+
+        heap.push_back(val);
+        std::push_heap(heap.begin(), heap.end(), Compare());
+        count++;
+    }
+
+    template <class T, class Compare>
+    const T &ExternalPriorityQueue<T, Compare>::top() const
+    {
+        UTILS_ASSERTD( !empty());
+        return fromRuns() ? merger.top().value : heap.front();
+    }
+
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::pop()
+    {
+        if ( empty()) return;
+
+        if ( fromRuns())
+        {
+            Run *run = merger.top().run;
+            merger.pop();
+            run->next();
+            if ( !run->empty())
+            {
+                Head head = {run->head(), run};
+                merger.push(head);
+            }
+        } else
+        {
+            std::pop_heap(heap.begin(), heap.end(), Compare());
+            heap.pop_back();
+        }
+        count--;
+    }
+
+    template <class T, class Compare>
+    typename ExternalPriorityQueue<T, Compare>::size_type ExternalPriorityQueue<T, Compare>::size() const
+    {
+        return count;
+    }
+
+    template <class T, class Compare>
+    bool ExternalPriorityQueue<T, Compare>::empty() const
+    {
+        return count == 0;
+    }
+
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::clear()
+    {
+        heap.clear();
+        merger.clear();
+        levels.clear();
+        count = 0;
+    }
+
+    template <class T, class Compare>
+    size_t ExternalPriorityQueue<T, Compare>::numRuns() const
+    {
+        size_t runs = 0;
+        for (const std::vector<std::unique_ptr<Run> > &level : levels) runs += level.size();
+        return runs;
+    }
+
+    /*
+     * The sorted heap is written greatest first, so a run is read back in the order of the queue
+     */
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::spill()
+    {
+        std::sort_heap(heap.begin(), heap.end(), Compare());
+        std::reverse(heap.begin(), heap.end());
+
+        std::unique_ptr<Run> run(new Run(dir));
+        run->write(heap.data(), heap.size());
+        run->start(block);
+        heap.clear();
+
+        addRun(std::move(run), 0);
+        rebuildMerger();
+    }
+
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::addRun(std::unique_ptr<Run> run, size_t level)
+    {
+        if ( levels.size() <= level) levels.resize(level + 1);
+        levels[level].push_back(std::move(run));
+        if ( levels[level].size() == External::fan_in) mergeLevel(level);
+    }
+
+    /*
+     * The runs of the level are merged from their current heads, the elements already taken by pop() are not
+     * rewritten. The output is written in blocks as big as all the read buffers of the level.
+     * The merger refers to the runs that are destroyed here; it is emptied first so that it does not keep them
+     * if a write throws, the caller rebuilds it
+     */
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::mergeLevel(size_t level)
+    {
+        merger.clear();
+
+        std::vector<std::unique_ptr<Run> > runs;
+        runs.swap(levels[level]);
+
+        Merger heads;
+        for (std::unique_ptr<Run> &run : runs)
+        {
+            if ( run->empty()) continue;
+            Head head = {run->head(), run.get()};
+            heads.push(head);
+        }
+
+        std::unique_ptr<Run> merged(new Run(dir));
+        std::vector<T> out;
+        out.reserve(External::fan_in * block);
+        while ( !heads.empty())
+        {
+            Run *run = heads.top().run;
+            out.push_back(heads.top().value);
+            heads.pop();
+            run->next();
+            if ( !run->empty())
+            {
+                Head head = {run->head(), run};
+                heads.push(head);
+            }
+            if ( out.size() == out.capacity())
+            {
+                merged->write(out.data(), out.size());
+                out.clear();
+            }
+        }
+        merged->write(out.data(), out.size());
+        merged->start(block);
+        runs.clear(); // Closes and removes the files of the merged runs
+
+        addRun(std::move(merged), level + 1);
+    }
+
+    template <class T, class Compare>
+    void ExternalPriorityQueue<T, Compare>::rebuildMerger()
+    {
+        merger.clear();
+        for (std::vector<std::unique_ptr<Run> > &level : levels)
+        {
+            // Exhausted runs are dropped here, until then they only stay out of the merger
+            level.erase( std::remove_if(level.begin(), level.end(),
+                                        [](const std::unique_ptr<Run> &run) { return run->empty(); }),
+                         level.end());
+            for (std::unique_ptr<Run> &run : level)
+            {
+                Head head = {run->head(), run.get()};
+                merger.push(head);
+            }
+        }
+    }
+
+    bool uTestExternalQueue(UnitTest *utest_p);
+
+} /* namespace Alg */
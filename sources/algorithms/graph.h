@@ -0,0 +1,642 @@
+/**
+* @file: graph.h
+* Interface and implementation of the CSR graph and of the graph algorithms
+* @ingroup Algorithms
+* @brief Compressed sparse row graph with spanning trees, shortest paths and BFS built on UF and PriorityQueue
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace Alg
+{
+    /** Vertex id that stands for no vertex, e.g. the parent of an unreached vertex */
+    const UInt32 no_vertex = ~UInt32(0);
+
+    /**
+     * Weighted edge of a graph
+     * @ingroup Algorithms
+     */
+    template <class Weight> struct GraphEdge
+    {
+        UInt32 from;
+        UInt32 to;
+        Weight weight;
+    };
+
+    /* Graph options */
+    enum GraphDirection { Directed, Undirected };
+
+    /**
+     * Graph in the compressed sparse row form. The arcs leaving a vertex lie together sorted by the target
+     * (parallel arcs by the weight), targets and weights are kept in separate arrays so that the traversals
+     * that need no weights touch only the targets. An undirected edge is stored as two arcs.
+     * The graph is built at once from an edge list
+     * @ingroup Algorithms
+     */
+    template <class Weight = UInt32> class Graph
+    {
+    public:
+        typedef Weight weight_type;
+        typedef GraphEdge<Weight> Edge;
+        typedef std::vector<Edge> EdgeList;
+
+        Graph();
+
+        /** Build the graph of the given edges, the vertex ids must be less than 'num_vertices' */
+        void build(UInt32 num_vertices, const EdgeList &edges, GraphDirection dir = Undirected);
+
+        /**
+         * Build the graph under the execution policy. The parallel policies place and sort the arcs on the shared
+         * ThreadPool, the result is the same as of the sequential build
+         */
+        template <class ExecutionPolicy>
+        typename execution::EnableIfPolicy<ExecutionPolicy>::type
+        build(const ExecutionPolicy &policy, UInt32 num_vertices, const EdgeList &edges,
+              GraphDirection dir = Undirected);
+
+        Graph transpose() const;                   /**< Graph with all the arcs reversed              */
+
+        UInt32 numVertices() const;                /**< Number of vertices                            */
+        size_t numArcs() const;                    /**< Stored arcs, two per edge of undirected graph */
+        GraphDirection direction() const;          /**< Direction given to build()                    */
+
+        UInt32 degree(UInt32 v) const;             /**< Number of the arcs leaving the vertex         */
+        const UInt32 *targets(UInt32 v) const;     /**< Targets of the arcs leaving the vertex        */
+        const Weight *weights(UInt32 v) const;     /**< Weights of the arcs leaving the vertex        */
+
+    private:
+        void buildImpl(UInt32 num_vertices, const EdgeList &edges, GraphDirection dir, bool parallel);
+
+        std::vector<size_t> offsets; // Arcs of vertex v are [offsets[v], offsets[v + 1])
+        std::vector<UInt32> heads;
+        std::vector<Weight> arc_weights;
+        GraphDirection dir;
+    };
+
+    /* Building blocks of the graph construction */
+    namespace GraphBuild
+    {
+        const size_t block = 1 << 14; // Elements processed by one task
+
+        /** Call body(first, last) for the blocks of [0, size), on the shared ThreadPool if 'parallel' */
+        template <class Body>
+        void forBlocks(size_t size, bool parallel, Body body)
+        {
+            if ( !parallel || size <= block)
+            {
+                if ( size > 0) body(size_t(0), size);
+                return;
+            }
+            ThreadPool::instance().parallelFor( (size + block - 1) / block, [&](size_t i)
+            {
+                body(i * block, std::min(size, (i + 1) * block));
+            });
+        }
+
+        /** Sort of the edges by weight: radix sort of the edges themselves for the radix-sortable weights */
+        template <class Weight>
+        void sortByWeight(std::vector< GraphEdge<Weight> > &edges, std::true_type radix_sortable)
+        {
+            SortBy::radixSort(edges.begin(), edges.end(),
+                              [](const GraphEdge<Weight> &edge) { return SortBy::radixBits(edge.weight); });
+        }
+
+        template <class Weight>
+        void sortByWeight(std::vector< GraphEdge<Weight> > &edges, std::false_type radix_sortable)
+        {
+            sortBy(edges.begin(), edges.end(), [](const GraphEdge<Weight> &edge) { return edge.weight; });
+        }
+
+        /** Random weight in [1, max_weight] */
+        template <class Weight>
+        Weight randomWeight(Xoshiro256 &rng, Weight max_weight, std::true_type is_integral)
+        {
+            return static_cast<Weight>( 1 + rng.bounded( static_cast<UInt64>(max_weight)));
+        }
+
+        /** Random weight in (0, max_weight] */
+        template <class Weight>
+        Weight randomWeight(Xoshiro256 &rng, Weight max_weight, std::false_type is_integral)
+        {
+            return max_weight * static_cast<Weight>( ((rng() >> 11) + 1) * (1.0 / 9007199254740992.0));
+        }
+    } /* namespace GraphBuild */
+
+    template <class Weight>
+    Graph<Weight>::Graph():
+        offsets(1, 0), dir(Undirected)
+    {
+
+    }
+
+    template <class Weight>
+    void Graph<Weight>::build(UInt32 num_vertices, const EdgeList &edges, GraphDirection direction)
+    {
+        buildImpl(num_vertices, edges, direction, false);
+    }
+
+    template <class Weight>
+    template <class ExecutionPolicy>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    Graph<Weight>::build(const ExecutionPolicy &policy, UInt32 num_vertices, const EdgeList &edges,
+                         GraphDirection direction)
+    {
+        buildImpl(num_vertices, edges, direction, execution::IsParallelPolicy<ExecutionPolicy>::value);
+    }
+
+    /*
+     * Counting sort of the arcs by the source: the degrees give the offsets, then every arc is put to the
+     * next free place of its source. The parallel build counts and places the arcs with atomic counters,
+     * which mixes the order of the arcs of a vertex, so each vertex sorts its arcs by (target, weight)
+     * afterwards and both builds give the same graph
+     */
+    template <class Weight>
+    void Graph<Weight>::buildImpl(UInt32 num_vertices, const EdgeList &edges, GraphDirection direction,
+                                  bool parallel)
+    {
+        typedef std::pair<UInt32, Weight> Arc;
+
+        size_t num_arcs = edges.size() * (direction == Undirected ? 2 : 1);
+        std::vector<Arc> arcs(num_arcs);
+        offsets.assign( static_cast<size_t>(num_vertices) + 1, 0);
+        dir = direction;
+
+        if ( parallel)
+        {
+            std::unique_ptr< std::atomic<size_t>[] > next(new std::atomic<size_t>[num_vertices]);
+            GraphBuild::forBlocks(num_vertices, true, [&](size_t first, size_t last)
+            {
+                for (size_t v = first; v < last; v++) next[v].store(0, std::memory_order_relaxed);
+            });
+            GraphBuild::forBlocks(edges.size(), true, [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                {
+                    UTILS_ASSERTD( edges[i].from < num_vertices && edges[i].to < num_vertices);
+                    next[edges[i].from].fetch_add(1, std::memory_order_relaxed);
+                    if ( direction == Undirected) next[edges[i].to].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            for (UInt32 v = 0; v < num_vertices; v++)
+            {
+                offsets[v + 1] = offsets[v] + next[v].load(std::memory_order_relaxed);
+            }
+            GraphBuild::forBlocks(num_vertices, true, [&](size_t first, size_t last)
+            {
+                for (size_t v = first; v < last; v++) next[v].store(offsets[v], std::memory_order_relaxed);
+            });
+            GraphBuild::forBlocks(edges.size(), true, [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                {
+                    const Edge &edge = edges[i];
+                    arcs[next[edge.from].fetch_add(1, std::memory_order_relaxed)] = Arc(edge.to, edge.weight);
+                    if ( direction == Undirected)
+                    {
+                        arcs[next[edge.to].fetch_add(1, std::memory_order_relaxed)] = Arc(edge.from, edge.weight);
+                    }
+                }
+            });
+        } else
+        {
+            for (const Edge &edge : edges)
+            {
+                UTILS_ASSERTD( edge.from < num_vertices && edge.to < num_vertices);
+                offsets[edge.from + 1]++;
+                if ( direction == Undirected) offsets[edge.to + 1]++;
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+            for (const Edge &edge : edges)
+            {
+                arcs[next[edge.from]++] = Arc(edge.to, edge.weight);
+                if ( direction == Undirected) arcs[next[edge.to]++] = Arc(edge.from, edge.weight);
+            }
+        }
+
+        heads.resize(num_arcs);
+        arc_weights.resize(num_arcs);
+        GraphBuild::forBlocks(num_vertices, parallel, [&](size_t first, size_t last)
+        {
+            for (size_t v = first; v < last; v++)
+            {
+                Alg::sort(arcs.begin() + offsets[v], arcs.begin() + offsets[v + 1]);
+                for (size_t i = offsets[v]; i < offsets[v + 1]; i++)
+                {
+                    heads[i] = arcs[i].first;
+                    arc_weights[i] = arcs[i].second;
+                }
+            }
+        });
+    }
+
+    template <class Weight>
+    Graph<Weight> Graph<Weight>::transpose() const
+    {
+        EdgeList reversed;
+        reversed.reserve( numArcs());
+        for (UInt32 v = 0; v < numVertices(); v++)
+        {
+            for (size_t i = offsets[v]; i < offsets[v + 1]; i++)
+            {
+                Edge arc = { heads[i], v, arc_weights[i] };
+                reversed.push_back(arc);
+            }
+        }
+
+        // The reversed arcs of an undirected graph are its own arcs, both directions are already there
+        Graph result;
+        result.build(numVertices(), reversed, Directed);
+        result.dir = dir;
+        return result;
+    }
+
+    template <class Weight>
+    UInt32 Graph<Weight>::numVertices() const
+    {
+        return static_cast<UInt32>( offsets.size() - 1);
+    }
+
+    template <class Weight>
+    size_t Graph<Weight>::numArcs() const
+    {
+        return heads.size();
+    }
+
+    template <class Weight>
+    GraphDirection Graph<Weight>::direction() const
+    {
+        return dir;
+    }
+
+    template <class Weight>
+    UInt32 Graph<Weight>::degree(UInt32 v) const
+    {
+        return static_cast<UInt32>( offsets[v + 1] - offsets[v]);
+    }
+
+    template <class Weight>
+    const UInt32 *Graph<Weight>::targets(UInt32 v) const
+    {
+        return heads.data() + offsets[v];
+    }
+
+    template <class Weight>
+    const Weight *Graph<Weight>::weights(UInt32 v) const
+    {
+        return arc_weights.data() + offsets[v];
+    }
+
+    /* Helpers of the graph searches */
+    namespace GraphSearch
+    {
+        /** Entry of the search queue: the vertex is reached from 'from' with the given key */
+        template <class Weight> struct Entry
+        {
+            Weight key;
+            UInt32 vertex;
+            UInt32 from;
+        };
+
+        /** Order of the PriorityQueue that puts the smallest key on the top */
+        template <class Weight> struct Later
+        {
+            bool operator()(const Entry<Weight> &a, const Entry<Weight> &b) const { return b.key < a.key; }
+        };
+
+        template <class Weight> struct Queue
+        {
+            typedef PriorityQueue< Entry<Weight>, std::allocator< Entry<Weight> >, Later<Weight> > type;
+        };
+
+        /* Parameters of the direction switch in BFS, from the paper by Beamer et al. */
+        const size_t bfs_alpha = 15;
+        const size_t bfs_beta = 18;
+
+        inline bool testBit(const std::vector<UInt64> &bits, UInt32 i)
+        {
+            return (bits[i >> 6] >> (i & 63)) & 1;
+        }
+
+        inline void setBit(std::vector<UInt64> &bits, UInt32 i)
+        {
+            bits[i >> 6] |= UInt64(1) << (i & 63);
+        }
+
+        /** Visit the arcs leaving the frontier, returns the number of the arcs leaving the next frontier */
+        template <class Weight>
+        size_t topDownStep(const Graph<Weight> &graph, std::vector<UInt32> &parent,
+                           const std::vector<UInt32> &frontier, std::vector<UInt32> &next)
+        {
+            size_t scout = 0;
+            next.clear();
+            for (UInt32 u : frontier)
+            {
+                const UInt32 *targets = graph.targets(u);
+                for (UInt32 i = 0, deg = graph.degree(u); i < deg; i++)
+                {
+                    UInt32 v = targets[i];
+                    if ( parent[v] != no_vertex) continue;
+
+                    parent[v] = u;
+                    next.push_back(v);
+                    scout += graph.degree(v);
+                }
+            }
+            return scout;
+        }
+
+        /**
+         * Every unreached vertex looks for a parent in the frontier among its incoming arcs and stops at the
+         * first one found. Returns the size of the next frontier, 'scout' receives the number of the arcs leaving it
+         */
+        template <class Weight>
+        size_t bottomUpStep(const Graph<Weight> &graph, const Graph<Weight> &transposed, std::vector<UInt32> &parent,
+                            const std::vector<UInt64> &front, std::vector<UInt64> &next, size_t &scout)
+        {
+            size_t awake = 0;
+            scout = 0;
+            std::fill(next.begin(), next.end(), 0);
+            for (UInt32 v = 0; v < transposed.numVertices(); v++)
+            {
+                if ( parent[v] != no_vertex) continue;
+
+                const UInt32 *sources = transposed.targets(v);
+                for (UInt32 i = 0, deg = transposed.degree(v); i < deg; i++)
+                {
+                    if ( testBit(front, sources[i]))
+                    {
+                        parent[v] = sources[i];
+                        setBit(next, v);
+                        awake++;
+                        scout += graph.degree(v);
+                        break;
+                    }
+                }
+            }
+            return awake;
+        }
+    } /* namespace GraphSearch */
+
+    /**
+     * Minimum spanning forest by Kruskal's algorithm: the edges are sorted by weight with the stable radix
+     * sort (sortBy for the weights that are not radix-sortable) and added unless they close a cycle, which
+     * is checked by TreeUF. The graph must be undirected. Ties are broken by the (from, to) order of the edges,
+     * so the result is deterministic
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void kruskalMST(const Graph<Weight> &graph, typename Graph<Weight>::EdgeList &forest)
+    {
+        typedef typename Graph<Weight>::Edge Edge;
+        UTILS_ASSERTD( graph.direction() == Undirected);
+
+        // Every edge once, without the loops
+        typename Graph<Weight>::EdgeList edges;
+        edges.reserve( graph.numArcs() / 2);
+        for (UInt32 v = 0; v < graph.numVertices(); v++)
+        {
+            const UInt32 *targets = graph.targets(v);
+            const Weight *weights = graph.weights(v);
+            for (UInt32 i = 0, deg = graph.degree(v); i < deg; i++)
+            {
+                if ( v >= targets[i]) continue;
+
+                Edge edge = { v, targets[i], weights[i] };
+                edges.push_back(edge);
+            }
+        }
+        GraphBuild::sortByWeight(edges, std::integral_constant<bool, SortBy::RadixTraits<Weight>::sortable>());
+
+        forest.clear();
+        TreeUF<> uf(graph.numVertices());
+        for (const Edge &edge : edges)
+        {
+            if ( forest.size() + 1 >= graph.numVertices()) break;
+            if ( uf.areConnected(edge.from, edge.to)) continue;
+
+            uf.unite(edge.from, edge.to);
+            forest.push_back(edge);
+        }
+    }
+
+    /**
+     * Minimum spanning forest by Prim's algorithm on the PriorityQueue. A vertex is queued again only when
+     * a lighter arc to it is found. The graph must be undirected. The edges of the forest are listed in
+     * the order they are added, each tree is grown from its smallest vertex
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void primMST(const Graph<Weight> &graph, typename Graph<Weight>::EdgeList &forest)
+    {
+        typedef GraphSearch::Entry<Weight> Entry;
+        enum State { Unseen, Queued, InTree };
+        UTILS_ASSERTD( graph.direction() == Undirected);
+
+        UInt32 num_vertices = graph.numVertices();
+        std::vector<UInt8> state(num_vertices, Unseen);
+        std::vector<Weight> best(num_vertices);
+        typename GraphSearch::Queue<Weight>::type queue;
+
+        forest.clear();
+        for (UInt32 root = 0; root < num_vertices; root++)
+        {
+            if ( state[root] != Unseen) continue;
+
+            Entry start = { Weight(), root, no_vertex };
+            queue.push(start);
+            while ( !queue.empty())
+            {
+                Entry entry = queue.top();
+                queue.pop();
+                if ( state[entry.vertex] == InTree) continue;
+
+                state[entry.vertex] = InTree;
+                if ( entry.from != no_vertex)
+                {
+                    typename Graph<Weight>::Edge edge = { entry.from, entry.vertex, entry.key };
+                    forest.push_back(edge);
+                }
+
+                const UInt32 *targets = graph.targets(entry.vertex);
+                const Weight *weights = graph.weights(entry.vertex);
+                for (UInt32 i = 0, deg = graph.degree(entry.vertex); i < deg; i++)
+                {
+                    UInt32 v = targets[i];
+                    if ( state[v] == InTree || (state[v] == Queued && !(weights[i] < best[v])) ) continue;
+
+                    state[v] = Queued;
+                    best[v] = weights[i];
+                    Entry next = { weights[i], v, entry.vertex };
+                    queue.push(next);
+                }
+            }
+        }
+    }
+
+    /**
+     * Shortest paths from the source by Dijkstra's algorithm on the PriorityQueue, the weights must not be
+     * negative. dist[v] is the length of the shortest path to v and parent[v] is the previous vertex on it;
+     * unreached vertices get the maximum of Weight and no_vertex, the parent of the source is the source
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void dijkstra(const Graph<Weight> &graph, UInt32 source, std::vector<Weight> &dist, std::vector<UInt32> &parent)
+    {
+        typedef GraphSearch::Entry<Weight> Entry;
+        UTILS_ASSERTD( source < graph.numVertices());
+
+        dist.assign( graph.numVertices(), std::numeric_limits<Weight>::max());
+        parent.assign( graph.numVertices(), no_vertex);
+        std::vector<UInt8> done( graph.numVertices(), 0);
+        typename GraphSearch::Queue<Weight>::type queue;
+
+        dist[source] = Weight();
+        parent[source] = source;
+        Entry start = { Weight(), source, source };
+        queue.push(start);
+
+        while ( !queue.empty())
+        {
+            Entry entry = queue.top();
+            queue.pop();
+
+            // Entries left behind by the later improvements of the distance are skipped
+            if ( done[entry.vertex]) continue;
+            done[entry.vertex] = 1;
+
+            const UInt32 *targets = graph.targets(entry.vertex);
+            const Weight *weights = graph.weights(entry.vertex);
+            for (UInt32 i = 0, deg = graph.degree(entry.vertex); i < deg; i++)
+            {
+                UInt32 v = targets[i];
+                Weight d = entry.key + weights[i];
+                if ( done[v] || !(d < dist[v])) continue;
+
+                dist[v] = d;
+                parent[v] = entry.vertex;
+                Entry next = { d, v, entry.vertex };
+                queue.push(next);
+            }
+        }
+    }
+
+    /**
+     * Direction-optimizing breadth-first search (Beamer et al.). Small frontiers are expanded top-down along
+     * the arcs of 'graph'; when the frontier has many arcs the search switches to bottom-up steps where the
+     * unreached vertices look for a parent among their incoming arcs, given by 'transposed'. parent[v] is
+     * the vertex v is reached from, no_vertex for unreached vertices, the parent of the source is the source
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void bfs(const Graph<Weight> &graph, const Graph<Weight> &transposed, UInt32 source, std::vector<UInt32> &parent)
+    {
+        using namespace GraphSearch;
+        UTILS_ASSERTD( source < graph.numVertices() && transposed.numVertices() == graph.numVertices());
+
+        UInt32 num_vertices = graph.numVertices();
+        parent.assign(num_vertices, no_vertex);
+        parent[source] = source;
+
+        std::vector<UInt32> frontier(1, source), next;
+        std::vector<UInt64> front_bits, next_bits;
+        size_t edges_to_check = graph.numArcs();
+        size_t scout = graph.degree(source);
+
+        while ( !frontier.empty())
+        {
+            if ( scout > edges_to_check / bfs_alpha)
+            {
+                front_bits.assign( (num_vertices + 63) / 64, 0);
+                next_bits.resize( front_bits.size());
+                for (UInt32 v : frontier) setBit(front_bits, v);
+
+                // Bottom-up while the frontier grows or stays big. The arcs of each frontier are counted as
+                // checked once it is used, like in the top-down steps
+                size_t awake = frontier.size(), old_awake;
+                do
+                {
+                    edges_to_check -= std::min(scout, edges_to_check);
+                    old_awake = awake;
+                    awake = bottomUpStep(graph, transposed, parent, front_bits, next_bits, scout);
+                    std::swap(front_bits, next_bits);
+                } while ( awake > 0 && (awake >= old_awake || awake > num_vertices / bfs_beta));
+
+                // The scout of the last step is the arc count of the rebuilt frontier
+                frontier.clear();
+                for (UInt32 v = 0; v < num_vertices && awake > 0; v++)
+                {
+                    if ( testBit(front_bits, v)) frontier.push_back(v);
+                }
+            } else
+            {
+                edges_to_check -= std::min(scout, edges_to_check);
+                scout = topDownStep(graph, parent, frontier, next);
+                std::swap(frontier, next);
+            }
+        }
+    }
+
+    /**
+     * Direction-optimizing BFS of an undirected graph, which is its own transpose
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void bfs(const Graph<Weight> &graph, UInt32 source, std::vector<UInt32> &parent)
+    {
+        UTILS_ASSERTD( graph.direction() == Undirected);
+        bfs(graph, graph, source, parent);
+    }
+
+    /**
+     * Edges of an R-MAT random graph (Chakrabarti, Zhan, Faloutsos) with 2^scale vertices. Each edge picks
+     * a quadrant of the adjacency matrix with the probabilities a, b, c and 1 - a - b - c, 'scale' times
+     * over; the defaults are the ones of Graph500. The vertex ids are permuted at random so that the big
+     * vertices are spread over the id range. Weights are uniform in [1, max_weight] for integral types
+     * and in (0, max_weight] for the others
+     * @ingroup Algorithms
+     */
+    template <class Weight>
+    void rmatEdges(UInt32 scale, size_t num_edges, Weight max_weight, Xoshiro256 &rng,
+                   std::vector< GraphEdge<Weight> > &edges, double a = 0.57, double b = 0.19, double c = 0.19)
+    {
+        UTILS_ASSERTD( scale < 32);
+
+        std::vector<UInt32> ids(UInt32(1) << scale);
+        std::iota(ids.begin(), ids.end(), 0);
+        shuffle(ids.begin(), ids.end(), rng);
+
+        edges.resize(num_edges);
+        for (GraphEdge<Weight> &edge : edges)
+        {
+            UInt32 from = 0, to = 0;
+            for (UInt32 level = 0; level < scale; level++)
+            {
+                double r = (rng() >> 11) * (1.0 / 9007199254740992.0);
+                UInt32 row = r >= a + b;
+                UInt32 col = (r >= a && r < a + b) || r >= a + b + c;
+                from = (from << 1) | row;
+                to = (to << 1) | col;
+            }
+            edge.from = ids[from];
+            edge.to = ids[to];
+            edge.weight = GraphBuild::randomWeight(rng, max_weight, typename std::is_integral<Weight>::type());
+        }
+    }
+
+    bool uTestGraph(UnitTest *utest_p);
+
+} /* namespace Alg */
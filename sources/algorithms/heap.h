@@ -64,7 +64,7 @@ namespace Alg
 
             if ( comp(*pred, *cur)) // predecessor is less than current element
             {
-                std::swap(*pred, *cur);
+                std::iter_swap(pred, cur);
                 return pred;
             }
             return bottom;
@@ -88,7 +88,7 @@ namespace Alg
             {
                 if (comp(*cur, *child1)) // current element is less than child element
                 {
-                    std::swap(*cur, *child1);
+                    std::iter_swap(cur, child1);
                     return child1;
                 }
                 return bottom;
@@ -98,7 +98,7 @@ namespace Alg
                 auto biggest_child = comp(*child1, *child2) ? child2 : child1;
                 if (comp(*cur, *biggest_child)) // current element is less than child element
                 {
-                    std::swap(*cur, *biggest_child);
+                    std::iter_swap(cur, biggest_child);
                     return biggest_child;
                 }
                 return bottom;
@@ -110,16 +110,20 @@ namespace Alg
     } /* namespace Heap */
 
     /**
-     * Heap-based implementation of the priority queue
+     * Heap-based implementation of the priority queue. The storage is taken from the
+     * allocator, any standard allocator works (e.g. ArenaAllocator from workspace.h, or
+     * LargeAllocator from large_storage.h for huge pages and NUMA placement of a big queue)
      */
-    template <class T, class Alloc = allocator<T>, class Compare = std::less<T> > class PriorityQueue
+    template <class T, class Alloc = std::allocator<T>, class Compare = std::less<T> > class PriorityQueue
     {
     public:
         /** A size type for the size() method */
         typedef typename std::vector< T, Alloc>::size_type size_type;
+        typedef Alloc allocator_type;
         
         //Interface
-        explicit PriorityQueue();  /**< Constructor            */
+        PriorityQueue();                                /**< Constructor                          */
+        explicit PriorityQueue(const Alloc &alloc);     /**< Constructor with the given allocator */
         void pop();                /**< Remove the top element */
         void push(const T& val);   /**< Insert element         */
         const T& top() const;      /**< Access the top element */
@@ -127,18 +131,28 @@ namespace Alg
         size_type size() const;    /**< Get the size of the queue   */
         bool empty() const;        /**< Check if the queue is empty */
 
+        void reserve(size_type n); /**< Reserve memory for n elements               */
+        void clear();              /**< Remove all the elements keeping the memory  */
+
     private:
         // Data is internally stored in a vector
         std::vector< T, Alloc> data;
     };
 
-    template <class T, class Alloc = allocator<T>, class Compare>
+    template <class T, class Alloc, class Compare>
     PriorityQueue<T,Alloc,Compare>::PriorityQueue()
     {
     
     }
 
-    template <class T, class Alloc = allocator<T>, class Compare> 
+    template <class T, class Alloc, class Compare>
+    PriorityQueue<T,Alloc,Compare>::PriorityQueue(const Alloc &alloc):
+        data(alloc)
+    {
+    
+    }
+
+    template <class T, class Alloc, class Compare> 
     void
     PriorityQueue<T, Alloc, Compare>::pop()
     {
@@ -149,7 +163,7 @@ namespace Alg
             auto last = std::prev(data.end());
             auto cur = data.begin();
 
-            swap(*cur, *last); //bottom element is placed at the top position
+            std::iter_swap(cur, last); //bottom element is placed at the top position
             data.pop_back();
         }
 
@@ -166,7 +180,7 @@ namespace Alg
         }
     }
     
-    template <class T, class Alloc = allocator<T>, class Compare>
+    template <class T, class Alloc, class Compare>
     void
     PriorityQueue<T, Alloc, Compare>::push(const T& val)
     {
@@ -184,25 +198,39 @@ namespace Alg
         }
     }
     
-    template <class T, class Alloc = allocator<T>, class Compare>
+    template <class T, class Alloc, class Compare>
     const T&
     PriorityQueue<T, Alloc, Compare>::top() const
     {
         return data.front();
     }
 
-    template <class T, class Alloc = allocator<T>, class Compare> 
+    template <class T, class Alloc, class Compare> 
     bool
     PriorityQueue<T, Alloc, Compare>::empty() const
     {
         return data.empty();
     }
         
-    template <class T, class Alloc = allocator<T>, class Compare> 
+    template <class T, class Alloc, class Compare> 
     typename PriorityQueue<T, Alloc, Compare>::size_type
     PriorityQueue<T, Alloc, Compare>::size() const
     {
         return data.size();
     }
 
+    template <class T, class Alloc, class Compare>
+    void
+    PriorityQueue<T, Alloc, Compare>::reserve(size_type n)
+    {
+        data.reserve(n);
+    }
+
+    template <class T, class Alloc, class Compare>
+    void
+    PriorityQueue<T, Alloc, Compare>::clear()
+    {
+        data.clear();
+    }
+
 } /* namespace Alg */
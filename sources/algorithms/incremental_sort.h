@@ -0,0 +1,248 @@
+/**
+* @file: incremental_sort.h
+* Interface and implementation of the incremental sort
+* @ingroup Algorithms
+* @brief Incremental quicksort that delivers the smallest elements in order on demand
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace Alg
+{
+    /* Helper routines of the incremental sort */
+    namespace Incremental
+    {
+        const size_t small_range = 16; // Ranges up to this size are sorted at once by insertion sort
+
+        /**
+         * Partition of [from, to) around the median of the first, middle and last elements. Returns the final
+         * position of the pivot: the elements before it are not greater, the elements after it are not less.
+         * The scans stop on the elements equal to the pivot, so ranges of equal keys are split in halves
+         */
+        template <class RandomAccessIterator, class Compare>
+        RandomAccessIterator partition(RandomAccessIterator from, RandomAccessIterator to, Compare &comp)
+        {
+            RandomAccessIterator mid = from + (to - from) / 2;
+            RandomAccessIterator last = to - 1;
+
+            if ( comp(*mid, *from)) std::iter_swap(mid, from);
+            if ( comp(*last, *mid))
+            {
+                std::iter_swap(last, mid);
+                if ( comp(*mid, *from)) std::iter_swap(mid, from);
+            }
+            std::iter_swap(from, mid); // The median is the pivot, the last element is not less than it
+
+            RandomAccessIterator i = from, j = to;
+            while (true)
+            {
+                while (comp(*++i, *from)) if (i == last) break;
+                while (comp(*from, *--j)) if (j == from) break;
+
+                if (i >= j) break;
+                std::iter_swap(i, j);
+            }
+            std::iter_swap(from, j);
+            return j;
+        }
+    } /* namespace Incremental */
+
+    /**
+     * Incremental quicksort (Paredes and Navarro) over a range. The i-th smallest element is found by
+     * partitioning only the part of the range that holds it; the pivots left on the way bound the ranges
+     * that are partitioned for the following elements. Getting the k smallest elements in order takes
+     * O(n + k log k) expected time, so each element costs amortized O(log n) and only the consumed prefix
+     * gets sorted. The object keeps its state between the calls: next() continues where the previous call
+     * stopped. Elements are moved within the range, [from, from + sorted()) always holds the smallest ones
+     * in order. The sort is not stable
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    class IncrementalSort
+    {
+    public:
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+        typedef typename std::iterator_traits<RandomAccessIterator>::reference reference;
+
+        class iterator;
+
+        IncrementalSort(RandomAccessIterator from, RandomAccessIterator to, Compare comp = Compare());
+
+        reference next();              /**< Next smallest element, must not be called after all are taken */
+        bool done() const;             /**< Whether all the elements are taken by next()                   */
+        size_t position() const;       /**< Number of the elements taken by next()                         */
+
+        reference operator[](size_t i); /**< The i-th smallest element, sorts the prefix up to it          */
+        void sortPrefix(size_t k);      /**< Put the k smallest elements to the front of the range in order */
+        size_t sorted() const;          /**< Length of the prefix that is already in its final order       */
+        size_t size() const;            /**< Number of the elements in the range                           */
+
+        iterator begin();              /**< Iterator over the elements in sorted order, sorts lazily */
+        iterator end();
+
+    private:
+        void settle(size_t i);         /**< Put the elements up to i to their final places */
+
+        RandomAccessIterator first;
+        size_t count;
+        size_t done_count;             // [first, first + done_count) is in the final order
+        size_t pos;                    // Elements taken by next()
+        std::vector<size_t> pivots;    // Positions of the pivots after done_count, the nearest is on the top
+        Compare comp;
+    };
+
+    /**
+     * Lazy iterator over the sorted sequence: an element is put to its place when the iterator is dereferenced
+     */
+    template <class RandomAccessIterator, class Compare>
+    class IncrementalSort<RandomAccessIterator, Compare>::iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename IncrementalSort::value_type value_type;
+        typedef typename IncrementalSort::reference reference;
+        typedef typename std::iterator_traits<RandomAccessIterator>::pointer pointer;
+        typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+
+        iterator(): sorter(nullptr), index(0){}
+        iterator(IncrementalSort *s, size_t i): sorter(s), index(i){}
+
+        reference operator*() const { return (*sorter)[index]; }
+        iterator &operator++() { ++index; return *this; }
+        iterator operator++(int) { iterator prev(*this); ++index; return prev; }
+
+        bool operator==(const iterator &other) const { return index == other.index; }
+        bool operator!=(const iterator &other) const { return index != other.index; }
+
+    private:
+        IncrementalSort *sorter;
+        size_t index;
+    };
+
+    template <class RandomAccessIterator, class Compare>
+    IncrementalSort<RandomAccessIterator, Compare>::IncrementalSort(RandomAccessIterator from, RandomAccessIterator to,
+                                                                    Compare c):
+        first(from), count(std::distance(from, to)), done_count(0), pos(0), pivots(1, count), comp(c)
+    {
+
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    typename IncrementalSort<RandomAccessIterator, Compare>::reference
+    IncrementalSort<RandomAccessIterator, Compare>::next()
+    {
+        settle(pos);
+        return first[pos++];
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    bool IncrementalSort<RandomAccessIterator, Compare>::done() const
+    {
+        return pos == count;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    size_t IncrementalSort<RandomAccessIterator, Compare>::position() const
+    {
+        return pos;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    typename IncrementalSort<RandomAccessIterator, Compare>::reference
+    IncrementalSort<RandomAccessIterator, Compare>::operator[](size_t i)
+    {
+        settle(i);
+        return first[i];
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    void IncrementalSort<RandomAccessIterator, Compare>::sortPrefix(size_t k)
+    {
+        if ( k > 0) settle( std::min(k, count) - 1);
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    size_t IncrementalSort<RandomAccessIterator, Compare>::sorted() const
+    {
+        return done_count;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    size_t IncrementalSort<RandomAccessIterator, Compare>::size() const
+    {
+        return count;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    typename IncrementalSort<RandomAccessIterator, Compare>::iterator
+    IncrementalSort<RandomAccessIterator, Compare>::begin()
+    {
+        return iterator(this, 0);
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    typename IncrementalSort<RandomAccessIterator, Compare>::iterator
+    IncrementalSort<RandomAccessIterator, Compare>::end()
+    {
+        return iterator(this, count);
+    }
+
+    /*
+     * The range between done_count and the nearest pivot holds the elements that go right after the sorted
+     * prefix. It is partitioned until the pivot is at done_count, which makes that pivot final; short ranges
+     * are finished by insertion sort at once
+     */
+    template <class RandomAccessIterator, class Compare>
+    void IncrementalSort<RandomAccessIterator, Compare>::settle(size_t i)
+    {
+        UTILS_ASSERTD( i < count);
+
+        while (done_count <= i)
+        {
+            size_t bound = pivots.back();
+            if ( bound == done_count)
+            {
+                pivots.pop_back();
+                done_count++;
+            } else if ( bound - done_count <= Incremental::small_range)
+            {
+                Merge::insertionSortRun(first + done_count, first + bound, comp);
+                done_count = bound;
+            } else
+            {
+                pivots.push_back( Incremental::partition(first + done_count, first + bound, comp) - first);
+            }
+        }
+    }
+
+    /**
+     * Incremental sort of the range, see IncrementalSort
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class Compare>
+    IncrementalSort<RandomAccessIterator, Compare>
+    incrementalSort(RandomAccessIterator from, RandomAccessIterator to, Compare comp)
+    {
+        return IncrementalSort<RandomAccessIterator, Compare>(from, to, comp);
+    }
+
+    template <class RandomAccessIterator>
+    IncrementalSort<RandomAccessIterator>
+    incrementalSort(RandomAccessIterator from, RandomAccessIterator to)
+    {
+        return IncrementalSort<RandomAccessIterator>(from, to);
+    }
+
+    bool uTestIncrementalSort(UnitTest *utest_p);
+
+} /* namespace Alg */
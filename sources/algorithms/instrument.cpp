@@ -0,0 +1,152 @@
+/**
+* @file: instrument.cpp
+* Implementation of the hardware performance counters and of the unit test instrumentation
+*/
+/*
+* Copyright (C) 2015  Boris Shurygin
+*/
+#include "alg_iface.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace Alg
+{
+    namespace Instrument
+    {
+#if defined(__linux__)
+        /** Open one counter of the calling thread on any CPU, returns -1 on failure */
+        static int openCounter(UInt32 type, UInt64 config)
+        {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = type;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            return static_cast<int>( syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+
+        PerfCounters::PerfCounters()
+        {
+            for (int i = 0; i < NumEvents; i++)
+            {
+                fds[i] = -1;
+                values[i] = 0;
+            }
+#if defined(__linux__)
+            fds[Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            fds[Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fds[BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+            fds[LLCMisses] = openCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL
+                                                             | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+        }
+
+        PerfCounters::~PerfCounters()
+        {
+#if defined(__linux__)
+            for (int fd : fds)
+            {
+                if ( fd >= 0) close(fd);
+            }
+#endif
+        }
+
+        void PerfCounters::start()
+        {
+#if defined(__linux__)
+            for (int fd : fds)
+            {
+                if ( fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        void PerfCounters::stop()
+        {
+#if defined(__linux__)
+            for (int fd : fds)
+            {
+                if ( fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+            for (int i = 0; i < NumEvents; i++)
+            {
+                UInt64 count = 0;
+                if ( fds[i] >= 0 && read(fds[i], &count, sizeof(count)) == sizeof(count) ) values[i] = count;
+                else values[i] = 0;
+            }
+#endif
+        }
+
+        bool PerfCounters::available(Event event) const
+        {
+            return fds[event] >= 0;
+        }
+
+        UInt64 PerfCounters::value(Event event) const
+        {
+            return values[event];
+        }
+
+        const char *PerfCounters::name(Event event)
+        {
+            static const char *names[NumEvents] = { "cycles", "instructions", "branch-misses", "LLC-misses" };
+            return names[event];
+        }
+
+        bool enabled()
+        {
+            static const bool is_enabled = ( std::getenv("ALG_INSTRUMENT") != nullptr );
+            return is_enabled;
+        }
+
+        TestScope::TestScope(const char *name):
+            test_name(name)
+        {
+            if ( !enabled()) return;
+
+            opCounts().reset();
+            counters.reset( new PerfCounters());
+            counters->start();
+        }
+
+        TestScope::~TestScope()
+        {
+            if ( !counters) return;
+
+            counters->stop();
+            std::cout << "  [" << test_name << "]";
+            for (int i = 0; i < PerfCounters::NumEvents; i++)
+            {
+                PerfCounters::Event event = static_cast<PerfCounters::Event>(i);
+                std::cout << " " << PerfCounters::name(event) << "=";
+                if ( counters->available(event)) std::cout << counters->value(event);
+                else std::cout << "n/a";
+            }
+
+            const OpCounts &ops = opCounts();
+            if ( !ops.empty())
+            {
+                std::cout << " compares=" << ops.compares << " copies=" << ops.copies
+                          << " moves=" << ops.moves << " swaps=" << ops.swaps;
+            }
+            std::cout << std::endl;
+        }
+    } /* namespace Instrument */
+} /* namespace Alg */
@@ -0,0 +1,196 @@
+/**
+* @file: instrument.h
+* Interface of the instrumentation of algorithms
+* @ingroup Algorithms
+* @brief Operation counting wrappers and hardware performance counters
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <utility>
+#include <functional>
+#include <memory>
+
+namespace Alg
+{
+    /* Instrumentation of algorithms */
+    namespace Instrument
+    {
+        /**
+         * Element operations counted by the Counted and CountingCompare wrappers
+         * @ingroup Algorithms
+         */
+        struct OpCounts
+        {
+            UInt64 compares;
+            UInt64 copies;  /**< Copy constructions and assignments */
+            UInt64 moves;   /**< Move constructions and assignments */
+            UInt64 swaps;   /**< Swaps found by argument-dependent lookup, e.g. by std::iter_swap */
+
+            OpCounts(): compares(0), copies(0), moves(0), swaps(0){}
+            void reset() { *this = OpCounts(); }
+            bool empty() const { return compares == 0 && copies == 0 && moves == 0 && swaps == 0; }
+        };
+
+        /**
+         * Counters of the calling thread
+         * @ingroup Algorithms
+         */
+        inline OpCounts &opCounts()
+        {
+            static thread_local OpCounts counts;
+            return counts;
+        }
+
+        /**
+         * Value wrapper that counts the compares, copies, moves and swaps done by an algorithm.
+         * Sorting a vector of Counted<T> instead of T gives the operation counts of any algorithm
+         * working with std::less or the comparison operators
+         * @ingroup Algorithms
+         */
+        template <class T> class Counted
+        {
+        public:
+            Counted(): val(){}
+            Counted(const T &v): val(v){}                                  /**< Wrapping is not counted */
+            Counted(const Counted &other): val(other.val) { opCounts().copies++; }
+            Counted(Counted &&other): val(std::move(other.val)) { opCounts().moves++; }
+
+            Counted &operator=(const Counted &other)
+            {
+                opCounts().copies++;
+                val = other.val;
+                return *this;
+            }
+            Counted &operator=(Counted &&other)
+            {
+                opCounts().moves++;
+                val = std::move(other.val);
+                return *this;
+            }
+
+            const T &value() const { return val; }
+
+            friend void swap(Counted &a, Counted &b)
+            {
+                using std::swap;
+                opCounts().swaps++;
+                swap(a.val, b.val);
+            }
+
+            friend bool operator<(const Counted &a, const Counted &b) { opCounts().compares++; return a.val < b.val; }
+            friend bool operator>(const Counted &a, const Counted &b) { opCounts().compares++; return b.val < a.val; }
+            friend bool operator<=(const Counted &a, const Counted &b) { opCounts().compares++; return !(b.val < a.val); }
+            friend bool operator>=(const Counted &a, const Counted &b) { opCounts().compares++; return !(a.val < b.val); }
+            friend bool operator==(const Counted &a, const Counted &b) { opCounts().compares++; return a.val == b.val; }
+            friend bool operator!=(const Counted &a, const Counted &b) { opCounts().compares++; return !(a.val == b.val); }
+
+        private:
+            T val;
+        };
+
+        /**
+         * Comparison wrapper that counts the calls of the wrapped comparison
+         * @ingroup Algorithms
+         */
+        template <class Compare> class CountingCompare
+        {
+        public:
+            explicit CountingCompare(Compare c = Compare()): comp(c){}
+
+            template <class A, class B>
+            bool operator()(const A &a, const B &b)
+            {
+                opCounts().compares++;
+                return comp(a, b);
+            }
+        private:
+            Compare comp;
+        };
+
+        /** Make a counting wrapper of the comparison */
+        template <class Compare>
+        CountingCompare<Compare> countingCompare(Compare comp)
+        {
+            return CountingCompare<Compare>(comp);
+        }
+
+        /**
+         * Hardware performance counters of the calling thread (perf_event_open on Linux).
+         * Counters that cannot be opened (other systems, no permission, virtual machines)
+         * are reported as not available and read as zero
+         * @ingroup Algorithms
+         */
+        class PerfCounters
+        {
+        public:
+            enum Event { Cycles, Instructions, BranchMisses, LLCMisses, NumEvents };
+
+            PerfCounters();  /**< Open the counters      */
+            ~PerfCounters(); /**< Close the counters     */
+
+            void start();    /**< Reset and start counting */
+            void stop();     /**< Stop counting and read the values */
+
+            bool available(Event event) const; /**< Whether the counter could be opened   */
+            UInt64 value(Event event) const;   /**< Value read by the last stop()          */
+
+            static const char *name(Event event);
+
+        private:
+            PerfCounters(const PerfCounters &);
+            PerfCounters &operator=(const PerfCounters &);
+
+            int fds[NumEvents];
+            UInt64 values[NumEvents];
+        };
+
+        /**
+         * Counts the hardware events of its lifetime: starts the counters on construction and
+         * stops them on destruction
+         * @ingroup Algorithms
+         */
+        class PerfScope
+        {
+        public:
+            explicit PerfScope(PerfCounters &c): counters(c) { counters.start(); }
+            ~PerfScope() { counters.stop(); }
+        private:
+            PerfCounters &counters;
+        };
+
+        /**
+         * Whether the instrumentation of the unit tests is on. It is turned on by setting the ALG_INSTRUMENT
+         * environment variable, the variable is read once
+         * @ingroup Algorithms
+         */
+        bool enabled();
+
+        /**
+         * Instrumentation of a unit test, used by ALG_RUN_TEST. When the instrumentation is enabled the hardware
+         * counters and the operation counts of the test are printed after it. Costs a single check otherwise
+         * @ingroup Algorithms
+         */
+        class TestScope
+        {
+        public:
+            explicit TestScope(const char *name);
+            ~TestScope();
+        private:
+            const char *test_name;
+            std::unique_ptr<PerfCounters> counters;
+        };
+    } /* namespace Instrument */
+
+    bool uTestInstrument(UnitTest *utest_p);
+
+} /* namespace Alg */
+
+/**
+ * Run the unit test under the instrumentation, see Alg::Instrument::TestScope
+ * @ingroup Algorithms
+ */
+#define ALG_RUN_TEST(test) { Alg::Instrument::TestScope alg_test_scope(#test); RUN_TEST(test); }
@@ -0,0 +1,244 @@
+/**
+* @file: interpolation_search.h
+* Interface and implementation of interpolation and learned-index search
+* @ingroup Algorithms
+* @brief Search over sorted numeric keys that uses the key values to predict the position
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace Alg
+{
+    /* Helper routines for the interpolation search */
+    namespace Interpolation
+    {
+        /** Number of interpolation rounds before falling back to binary search */
+        const unsigned max_rounds = 3;
+
+        /** Length of the sequential scan that follows an interpolation probe */
+        const std::ptrdiff_t scan_length = 8;
+
+        /** Predict the position of the value between 'lo' and 'hi' by linear interpolation of their keys */
+        template <class Value, class RandomAccessIterator>
+        RandomAccessIterator interpolate(const Value &val, RandomAccessIterator lo, RandomAccessIterator hi)
+        {
+            double lo_key = static_cast<double>(*lo);
+            double hi_key = static_cast<double>(*hi);
+            if ( !(hi_key > lo_key) ) return lo;
+
+            double fraction = (static_cast<double>(val) - lo_key) / (hi_key - lo_key);
+            fraction = std::min(1.0, std::max(0.0, fraction));
+            return lo + static_cast<std::ptrdiff_t>( fraction * std::distance(lo, hi));
+        }
+    } /* namespace Interpolation */
+
+    /**
+     * Find the first element between the 'from' and 'to' iterators that is not less than the given value,
+     * using the interpolation-sequential search: the position is predicted from the key values and the
+     * neighborhood of the prediction is scanned sequentially. If the scan does not settle the answer the range
+     * is narrowed and the prediction is repeated, after a few rounds the search falls back to binary search
+     * in the remaining window. Values must be numeric and ordered consistently with 'comp'
+     * @ingroup Algorithms
+     */
+    template <class Value, class RandomAccessIterator, class Compare = std::less<Value> >
+    RandomAccessIterator interpolationLowerBound(const Value &val, RandomAccessIterator from, RandomAccessIterator to,
+                                                 Compare comp = std::less<Value>())
+    {
+        if (from == to) return to;
+
+        // Answer is in [lo, hi + 1], *lo < val <= *hi holds inside the loop
+        if ( !comp( *from, val) ) return from;
+        auto lo = from;
+        auto hi = to - 1;
+        if ( comp( *hi, val) ) return to;
+
+        for (unsigned round = 0; round < Interpolation::max_rounds && std::distance(lo, hi) > 1; round++)
+        {
+            auto probe = Interpolation::interpolate(val, lo, hi);
+
+            if ( comp( *probe, val) )
+            {
+                // Scan forward for the first element not less than the value
+                auto limit = probe + std::min(Interpolation::scan_length, std::distance(probe, hi));
+                for (auto cur = probe + 1; cur <= limit; ++cur)
+                {
+                    if ( !comp( *cur, val) ) return cur;
+                }
+                lo = limit;
+            } else
+            {
+                // Scan backward for the last element less than the value
+                auto limit = probe - std::min(Interpolation::scan_length, std::distance(lo, probe));
+                for (auto cur = probe - 1; cur >= limit; --cur)
+                {
+                    if ( comp( *cur, val) ) return cur + 1;
+                }
+                hi = limit;
+            }
+        }
+        return lowerBound(val, lo + 1, hi + 1, comp);
+    }
+
+    /**
+     * Interpolation-sequential search of element's iterator based on its value. Search is done between
+     * the 'from' and 'to' iterators. Returns the first element equal to the value or 'to' if there is none
+     * @ingroup Algorithms
+     */
+    template <class Value, class RandomAccessIterator, class Compare = std::less<Value> >
+    RandomAccessIterator interpolationSearch(const Value &val, RandomAccessIterator from, RandomAccessIterator to,
+                                             Compare comp = std::less<Value>())
+    {
+        auto pos = interpolationLowerBound(val, from, to, comp);
+
+        if ( pos != to && !comp( val, *pos) ) return pos;
+        return to;
+    }
+
+    /**
+     * Returns iterator corresponding to the given value in the container using the interpolation search
+     * @ingroup Algorithms
+     */
+    template <class Value, class Container, class Compare = std::less<Value> >
+    typename Container::iterator interpolationSearch(const Value &val, Container &data, Compare comp = std::less<Value>())
+    {
+        return interpolationSearch(val, data.begin(), data.end(), comp);
+    }
+
+    /**
+     * Learned index over a sorted vector of numeric keys in the style of the PGM index. The keys are covered
+     * by linear segments: within a segment the position of every distinct key is predicted with an error of
+     * at most 'max_error'. A lookup finds the segment by binary search over the segment keys, evaluates the
+     * model and does a binary search in the window of 2 * max_error elements around the prediction.
+     * The index keeps a reference to the vector, it must not change while the index is used
+     * @ingroup Algorithms
+     */
+    template <class Key> class LearnedIndex
+    {
+    public:
+        typedef typename std::vector<Key>::const_iterator const_iterator;
+
+        /** Build the index over the sorted keys */
+        explicit LearnedIndex(const std::vector<Key> &keys, size_t max_error = 32);
+
+        const_iterator lowerBound(const Key &val) const; /**< First key not less than the value or end */
+        const_iterator find(const Key &val) const;       /**< First key equal to the value or end      */
+
+        size_t numSegments() const;                      /**< Number of linear segments of the model   */
+
+    private:
+        /** Linear model of positions: pos = start + slope * (key - first_key) */
+        struct Segment
+        {
+            double slope;
+            size_t start;
+        };
+
+        const std::vector<Key> &data;
+        size_t max_error;
+        std::vector<Key> first_keys; // First key of every segment, searched to select the segment
+        std::vector<Segment> segments;
+    };
+
+    template <class Key>
+    LearnedIndex<Key>::LearnedIndex(const std::vector<Key> &keys, size_t error):
+        data(keys), max_error(error)
+    {
+        UTILS_ASSERTD( std::is_sorted(keys.begin(), keys.end()));
+
+        // Shrinking cone: keep the range of slopes that fit all points of the segment within the error
+        size_t pos = 0;
+        while (pos < data.size())
+        {
+            Key first = data[pos];
+            Segment segment = { 0, pos };
+            double slope_lo = 0;
+            double slope_hi = std::numeric_limits<double>::infinity();
+
+            size_t cur = pos + 1;
+            while (cur < data.size())
+            {
+                // Only the first occurrence of a key is a lower bound position, duplicates are skipped
+                if ( data[cur] == data[cur - 1])
+                {
+                    cur++;
+                    continue;
+                }
+
+                double dx = static_cast<double>(data[cur]) - static_cast<double>(first);
+                double dy = static_cast<double>(cur - pos);
+                double lo = (dy - max_error) / dx;
+                double hi = (dy + max_error) / dx;
+
+                if ( lo > slope_hi || hi < slope_lo) break; // Point does not fit, start a new segment
+
+                slope_lo = std::max(slope_lo, lo);
+                slope_hi = std::min(slope_hi, hi);
+                cur++;
+            }
+
+            segment.slope = (slope_hi == std::numeric_limits<double>::infinity()) ? slope_lo : (slope_lo + slope_hi) / 2;
+            first_keys.push_back(first);
+            segments.push_back(segment);
+            pos = cur;
+        }
+    }
+
+    template <class Key>
+    typename LearnedIndex<Key>::const_iterator
+    LearnedIndex<Key>::lowerBound(const Key &val) const
+    {
+        if ( data.empty() || !(data.front() < val) ) return data.begin();
+
+        // The last segment starting at a key less than the value
+        size_t seg = Alg::lowerBound(val, first_keys.begin(), first_keys.end()) - first_keys.begin() - 1;
+        const Segment &segment = segments[seg];
+
+        double predicted = segment.start
+                           + segment.slope * (static_cast<double>(val) - static_cast<double>(first_keys[seg]));
+        predicted = std::min(predicted, static_cast<double>(data.size()));
+        size_t guess = static_cast<size_t>( std::max(predicted, 0.0));
+
+        // Bounded binary search in the error window
+        size_t lo = guess > max_error + 1 ? guess - max_error - 1 : 0;
+        size_t hi = std::min(data.size(), guess + max_error + 2);
+        auto res = Alg::lowerBound(val, data.begin() + lo, data.begin() + hi);
+
+        // Long runs of duplicates or gaps between segments can put the answer outside the window
+        if ( res == data.begin() + lo && lo > 0 && !(data[lo - 1] < val) )
+        {
+            res = Alg::lowerBound(val, data.begin(), data.begin() + lo);
+        } else if ( res == data.begin() + hi && hi < data.size())
+        {
+            res = Alg::lowerBound(val, data.begin() + hi, data.end());
+        }
+        return res;
+    }
+
+    template <class Key>
+    typename LearnedIndex<Key>::const_iterator
+    LearnedIndex<Key>::find(const Key &val) const
+    {
+        auto pos = lowerBound(val);
+
+        if ( pos != data.end() && !(val < *pos) ) return pos;
+        return data.end();
+    }
+
+    template <class Key>
+    size_t LearnedIndex<Key>::numSegments() const
+    {
+        return segments.size();
+    }
+
+    bool uTestInterpolationSearch(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -0,0 +1,276 @@
+/**
+* @file: large_storage.h
+* Interface and implementation of the storage of big arrays
+* @ingroup Algorithms
+* @brief Allocation of big arrays on huge pages with their pages placed across NUMA nodes
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <new>
+#include <limits>
+#include <algorithm>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    if defined(ALG_USE_LIBNUMA)
+#        include <numa.h>
+#    endif
+#endif
+
+namespace Alg
+{
+    /** Pages of the big arrays */
+    enum StoragePages
+    {
+        SmallPages,           /**< Pages of the system default size                               */
+        TransparentHugePages, /**< Ordinary memory advised to be backed by transparent huge pages */
+        ExplicitHugePages     /**< Reserved huge pages (hugetlbfs), transparent ones if none left */
+    };
+
+    /** Placement of the pages of the big arrays on the NUMA nodes */
+    enum StoragePlacement
+    {
+        LocalPlacement,       /**< The node of the thread that writes a page first (system default) */
+        InterleavedPlacement, /**< Pages go round-robin to all the allowed nodes                   */
+        SpreadPlacement       /**< Pages are first written in parallel by the threads of the pool  */
+    };
+
+    /**
+     * How the big arrays are stored. Allocations smaller than min_bytes are always ordinary ones.
+     * The default options keep the ordinary allocation for everything
+     * @ingroup Algorithms
+     */
+    struct StorageOptions
+    {
+        StoragePages pages;
+        StoragePlacement placement;
+        size_t min_bytes;
+
+        StorageOptions(StoragePages p = SmallPages, StoragePlacement n = LocalPlacement,
+                       size_t min = 2 * 1024 * 1024):
+            pages(p), placement(n), min_bytes(min){}
+
+        /** Whether an allocation of the given size is stored differently from an ordinary one */
+        bool special(size_t bytes) const
+        {
+            return bytes >= min_bytes && (pages != SmallPages || placement != LocalPlacement);
+        }
+
+        bool operator==(const StorageOptions &other) const
+        {
+            return pages == other.pages && placement == other.placement && min_bytes == other.min_bytes;
+        }
+        bool operator!=(const StorageOptions &other) const { return !(*this == other); }
+    };
+
+    /* Memory mapping and page placement routines of the big arrays */
+    namespace Storage
+    {
+        const size_t huge_page = 2 * 1024 * 1024; // Size of a huge page and the unit of the parallel first touch
+
+        inline size_t roundUp(size_t bytes, size_t unit)
+        {
+            return (bytes + unit - 1) / unit * unit;
+        }
+
+        inline size_t pageSize()
+        {
+#if defined(__linux__)
+            static const size_t size = static_cast<size_t>( sysconf(_SC_PAGESIZE));
+            return size;
+#else
+            return 4096;
+#endif
+        }
+
+#if defined(__linux__) && !defined(ALG_USE_LIBNUMA)
+        const int mpol_interleave = 3;          // MPOL_INTERLEAVE of linux/mempolicy.h
+        const unsigned long mpol_f_mems_allowed = 1 << 2; // MPOL_F_MEMS_ALLOWED
+        const unsigned long max_nodes = 1024;
+
+        /** Mask of the nodes the process may allocate on, false if the kernel has no NUMA support */
+        inline bool allowedNodes(unsigned long (&mask)[max_nodes / (8 * sizeof(unsigned long))])
+        {
+            int mode = 0;
+            std::fill(mask, mask + max_nodes / (8 * sizeof(unsigned long)), 0);
+            return syscall(SYS_get_mempolicy, &mode, mask, max_nodes, nullptr, mpol_f_mems_allowed) == 0;
+        }
+#endif
+
+        /** Number of the NUMA nodes the memory can be placed on */
+        inline unsigned numaNodes()
+        {
+#if defined(__linux__) && defined(ALG_USE_LIBNUMA)
+            return numa_available() < 0 ? 1 : static_cast<unsigned>( numa_num_task_nodes());
+#elif defined(__linux__)
+            unsigned long mask[max_nodes / (8 * sizeof(unsigned long))];
+            if ( !allowedNodes(mask)) return 1;
+
+            unsigned nodes = 0;
+            for (unsigned long word : mask)
+            {
+                for (; word != 0; word &= word - 1) nodes++;
+            }
+            return std::max(nodes, 1u);
+#else
+            return 1;
+#endif
+        }
+
+        /** Interleave the pages of the range over the allowed nodes, the pages already in memory are moved */
+        inline void interleave(void *ptr, size_t bytes)
+        {
+#if defined(__linux__) && defined(ALG_USE_LIBNUMA)
+            if ( numa_available() >= 0) numa_interleave_memory(ptr, bytes, numa_all_nodes_ptr);
+#elif defined(__linux__)
+            unsigned long mask[max_nodes / (8 * sizeof(unsigned long))];
+            const unsigned mpol_mf_move = 1 << 1; // MPOL_MF_MOVE
+            if ( allowedNodes(mask))
+            {
+                syscall(SYS_mbind, ptr, bytes, mpol_interleave, mask, max_nodes, mpol_mf_move);
+            }
+#endif
+        }
+
+        /**
+         * Apply the page size and the placement to the pages that lie entirely within the range.
+         * These are hints: whatever the system does not support is left as it is
+         */
+        inline void advise(void *ptr, size_t bytes, const StorageOptions &options)
+        {
+#if defined(__linux__)
+            size_t page = pageSize();
+            size_t from = roundUp( reinterpret_cast<size_t>(ptr), page);
+            size_t to = (reinterpret_cast<size_t>(ptr) + bytes) / page * page;
+            if ( from >= to) return;
+
+#    if defined(MADV_HUGEPAGE)
+            if ( options.pages != SmallPages) madvise( reinterpret_cast<void *>(from), to - from, MADV_HUGEPAGE);
+#    endif
+            if ( options.placement == InterleavedPlacement) interleave( reinterpret_cast<void *>(from), to - from);
+#endif
+        }
+
+        /**
+         * Write the range in parallel on the shared pool, each task writes a contiguous part of huge pages.
+         * The pages that are not in memory yet are placed on the nodes of the writing threads; pinning the
+         * workers (ThreadPool::Config::cpus) makes the placement follow the sockets.
+         * The range must hold no objects yet
+         */
+        inline void touch(void *ptr, size_t bytes)
+        {
+            ThreadPool &pool = ThreadPool::instance();
+            size_t num_pages = roundUp(bytes, huge_page) / huge_page;
+            size_t num_tasks = std::min<size_t>(pool.numThreads(), num_pages);
+            char *mem = static_cast<char *>(ptr);
+
+            pool.parallelFor(num_tasks, [mem, bytes, num_pages, num_tasks](size_t i)
+            {
+                size_t to = std::min(bytes, num_pages * (i + 1) / num_tasks * huge_page);
+                for (size_t pos = num_pages * i / num_tasks * huge_page; pos < to; pos += pageSize()) mem[pos] = 0;
+            });
+        }
+
+        /**
+         * Map memory for a big array. Explicit huge pages are tried first if requested; otherwise the
+         * mapping is aligned to the huge page size so that transparent huge pages can back all of it
+         */
+        inline void *map(size_t bytes, const StorageOptions &options)
+        {
+#if defined(__linux__)
+            size_t length = roundUp(bytes, huge_page);
+            void *ptr = MAP_FAILED;
+#    if defined(MAP_HUGETLB)
+            if ( options.pages == ExplicitHugePages)
+            {
+                ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if ( ptr != MAP_FAILED && options.placement == InterleavedPlacement) interleave(ptr, length);
+            }
+#    endif
+            if ( ptr == MAP_FAILED)
+            {
+                // Map one huge page more and cut the ends off to get an aligned mapping
+                void *raw = mmap(nullptr, length + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if ( raw == MAP_FAILED) throw std::bad_alloc();
+
+                char *start = reinterpret_cast<char *>( roundUp( reinterpret_cast<size_t>(raw), huge_page));
+                char *end = start + length;
+                if ( start != raw) munmap(raw, start - static_cast<char *>(raw));
+                if ( end != static_cast<char *>(raw) + length + huge_page)
+                {
+                    munmap(end, static_cast<char *>(raw) + length + huge_page - end);
+                }
+                ptr = start;
+                advise(ptr, length, options);
+            }
+            if ( options.placement == SpreadPlacement) touch(ptr, length);
+            return ptr;
+#else
+            return ::operator new(bytes);
+#endif
+        }
+
+        /** Unmap the memory taken by map() */
+        inline void unmap(void *ptr, size_t bytes)
+        {
+#if defined(__linux__)
+            munmap(ptr, roundUp(bytes, huge_page));
+#else
+            ::operator delete(ptr);
+#endif
+        }
+    } /* namespace Storage */
+
+    /**
+     * Standard allocator for big arrays: the allocations the options apply to are mapped directly from the
+     * system on huge pages and with the requested NUMA placement, the smaller ones go to operator new.
+     * Can be used with the standard containers and with PriorityQueue; TreeUF and Workspace take the
+     * options directly. Huge pages and placement are supported on Linux, elsewhere the allocations are
+     * ordinary ones. With ALG_USE_LIBNUMA the placement goes through libnuma (link with -lnuma),
+     * otherwise through the system calls
+     * @ingroup Algorithms
+     */
+    template <class T> class LargeAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template <class U> struct rebind { typedef LargeAllocator<U> other; };
+
+        LargeAllocator(const StorageOptions &opt = StorageOptions()): options(opt){}
+        template <class U> LargeAllocator(const LargeAllocator<U> &other): options(other.options){}
+
+        T *allocate(size_t n)
+        {
+            if ( n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_alloc();
+
+            size_t bytes = n * sizeof(T);
+            if ( options.special(bytes)) return static_cast<T *>( Storage::map(bytes, options));
+            return static_cast<T *>( ::operator new(bytes));
+        }
+        void deallocate(T *ptr, size_t n)
+        {
+            if ( options.special(n * sizeof(T))) Storage::unmap(ptr, n * sizeof(T));
+            else ::operator delete(ptr);
+        }
+
+        const StorageOptions &storage() const { return options; }
+
+        template <class U> bool operator==(const LargeAllocator<U> &other) const { return options == other.options; }
+        template <class U> bool operator!=(const LargeAllocator<U> &other) const { return options != other.options; }
+
+    private:
+        template <class U> friend class LargeAllocator;
+
+        StorageOptions options;
+    };
+
+    bool uTestLargeStorage(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -0,0 +1,183 @@
+/**
+* @file: random.h
+* Interface and implementation of the pseudo-random number generator
+* @ingroup Algorithms
+* @brief Fast seedable generator (xoshiro256**) with nearly divisionless bounded ranges
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <random>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#    include <intrin.h>
+#endif
+
+namespace Alg
+{
+    /**
+     * Pseudo-random number generator xoshiro256** by Blackman and Vigna. Satisfies the requirements of
+     * the uniform random bit generator, so it can be used with the standard distributions as well.
+     * jump() advances the state by 2^128 steps and gives independent streams for parallel use
+     * @ingroup Algorithms
+     */
+    class Xoshiro256
+    {
+    public:
+        typedef UInt64 result_type;
+
+        explicit Xoshiro256(UInt64 seed = 0x9E3779B97F4A7C15ull); /**< Seeded generator                         */
+        void seed(UInt64 seed);                                  /**< Reset the state from the seed            */
+        void jump();                                             /**< Advance the state by 2^128 steps          */
+
+        inline UInt64 operator()();                              /**< Next random 64-bit number                 */
+        inline UInt64 bounded(UInt64 range);                     /**< Uniform random number in [0, range)       */
+        inline bool flip();                                      /**< Random bit                                */
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~UInt64(0); }
+
+    private:
+        static inline UInt64 rotl(UInt64 x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        UInt64 state[4];
+        UInt64 bits;     // Cached random bits for flip()
+        UInt32 num_bits; // Number of unused bits in 'bits'
+    };
+
+    inline Xoshiro256::Xoshiro256(UInt64 s)
+    {
+        seed(s);
+    }
+
+    /* State is filled by SplitMix64 so that any seed (including 0) gives a good state */
+    inline void Xoshiro256::seed(UInt64 s)
+    {
+        for (UInt64 &word : state)
+        {
+            s += 0x9E3779B97F4A7C15ull;
+            UInt64 z = s;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+        bits = 0;
+        num_bits = 0;
+    }
+
+    inline void Xoshiro256::jump()
+    {
+        static const UInt64 jump_poly[] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                            0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+        UInt64 s[4] = { 0, 0, 0, 0 };
+        for (UInt64 poly : jump_poly)
+        {
+            for (int b = 0; b < 64; b++)
+            {
+                if (poly & (UInt64(1) << b))
+                {
+                    for (int i = 0; i < 4; i++) s[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; i++) state[i] = s[i];
+        num_bits = 0;
+    }
+
+    inline UInt64 Xoshiro256::operator()()
+    {
+        UInt64 result = rotl(state[1] * 5, 7) * 9;
+        UInt64 t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    /*
+     * Lemire's nearly divisionless method: the high half of random * range is uniform in [0, range)
+     * once the few biased low halves are rejected; the division is needed only in the rare rejection case
+     */
+    inline UInt64 Xoshiro256::bounded(UInt64 range)
+    {
+        if (range <= 0xFFFFFFFFull)
+        {
+            UInt32 range32 = static_cast<UInt32>(range);
+            UInt64 m = ((*this)() >> 32) * range32;
+            UInt32 low = static_cast<UInt32>(m);
+            if (low < range32)
+            {
+                UInt32 threshold = static_cast<UInt32>(-range32) % range32;
+                while (low < threshold)
+                {
+                    m = ((*this)() >> 32) * range32;
+                    low = static_cast<UInt32>(m);
+                }
+            }
+            return m >> 32;
+        }
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 m = static_cast<unsigned __int128>((*this)()) * range;
+        UInt64 low = static_cast<UInt64>(m);
+        if (low < range)
+        {
+            UInt64 threshold = (0 - range) % range;
+            while (low < threshold)
+            {
+                m = static_cast<unsigned __int128>((*this)()) * range;
+                low = static_cast<UInt64>(m);
+            }
+        }
+        return static_cast<UInt64>(m >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        UInt64 high;
+        UInt64 low = _umul128((*this)(), range, &high);
+        if (low < range)
+        {
+            UInt64 threshold = (0 - range) % range;
+            while (low < threshold) low = _umul128((*this)(), range, &high);
+        }
+        return high;
+#else
+        // Plain rejection sampling for the wide ranges
+        UInt64 limit = max() - max() % range;
+        UInt64 r;
+        do { r = (*this)(); } while (r >= limit);
+        return r % range;
+#endif
+    }
+
+    inline bool Xoshiro256::flip()
+    {
+        if (num_bits == 0)
+        {
+            bits = (*this)();
+            num_bits = 64;
+        }
+        bool res = bits & 1;
+        bits >>= 1;
+        num_bits--;
+        return res;
+    }
+
+    /**
+     * Generator for the calls that are not given one: seeded from std::random_device once per thread
+     * @ingroup Algorithms
+     */
+    inline Xoshiro256 &defaultRandomGenerator()
+    {
+        static thread_local Xoshiro256 gen( (static_cast<UInt64>( std::random_device()()) << 32)
+                                            ^ std::random_device()());
+        return gen;
+    }
+
+} /* namespace Alg */
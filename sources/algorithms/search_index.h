@@ -0,0 +1,199 @@
+/**
+* @file: search_index.h
+* Interface and implementation of the static search index
+* @ingroup Algorithms
+* @brief Search over a sorted sequence stored in the cache-friendly Eytzinger (BFS heap) layout
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+namespace Alg
+{
+    /* Helper routines for the Eytzinger layout */
+    namespace Eytzinger
+    {
+        /** Number of trailing one bits of the number */
+        inline unsigned trailingOnes(UInt64 val)
+        {
+            if ( ~val == 0) return 64;
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(~val);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long pos;
+            _BitScanForward64(&pos, ~val);
+            return pos;
+#else
+            unsigned count = 0;
+            while (val & 1)
+            {
+                val >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+
+        /** Position of the highest one bit of a non-zero number */
+        inline unsigned highBit(UInt64 val)
+        {
+            UTILS_ASSERTD( val != 0);
+#if defined(__GNUC__) || defined(__clang__)
+            return 63 - __builtin_clzll(val);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long pos;
+            _BitScanReverse64(&pos, val);
+            return pos;
+#else
+            unsigned pos = 0;
+            while (val >>= 1) pos++;
+            return pos;
+#endif
+        }
+    } /* namespace Eytzinger */
+
+    /**
+     * Static search index built once from a sorted sequence. Elements are stored in the Eytzinger
+     * layout: node k has children 2k and 2k+1, so the top levels of the tree share a few cache lines
+     * and the descent is a branchless loop that prefetches the nodes four levels ahead.
+     * Positions returned by the lookups refer to the original sorted sequence, they are computed from
+     * the node numbers so the index takes no memory besides the elements
+     * @ingroup Algorithms
+     */
+    template <class T, class Compare = std::less<T> > class StaticSearchIndex
+    {
+    public:
+        /** Build the index from the sorted sequence between the iterators */
+        template <class RandomAccessIterator>
+        StaticSearchIndex(RandomAccessIterator from, RandomAccessIterator to, Compare comp = Compare());
+
+        size_t lowerBound(const T &val) const; /**< Position of the first element not less than val or size() */
+        size_t upperBound(const T &val) const; /**< Position of the first element greater than val or size()  */
+        size_t find(const T &val) const;       /**< Position of an element equal to val or size()              */
+
+        size_t size() const;                   /**< Number of the indexed elements */
+
+    private:
+        /** Fill the subtree of the given node with consecutive elements (in-order traversal) */
+        template <class RandomAccessIterator>
+        void build(RandomAccessIterator &cur, size_t node);
+
+        /** Descend the tree going right while the predicate holds, returns the last node where we went left or 0 */
+        template <class GoRight> size_t descend(GoRight go_right) const;
+
+        size_t rank(size_t node) const;   /**< Position of the node's element in the sorted sequence, size() for 0 */
+
+        std::vector<T> tree;      // Elements in Eytzinger order, tree[0] is unused
+        unsigned last_level;      // Depth of the deepest level of the tree
+        size_t last_level_size;   // Number of the nodes on the deepest level
+        mutable Compare comp;
+    };
+
+    template <class T, class Compare>
+    template <class RandomAccessIterator>
+    StaticSearchIndex<T, Compare>::StaticSearchIndex(RandomAccessIterator from, RandomAccessIterator to,
+                                                     Compare c):
+        tree(std::distance(from, to) + 1), last_level(0), last_level_size(0), comp(c)
+    {
+        UTILS_ASSERTD( std::is_sorted(from, to, comp));
+
+        build(from, 1);
+        if ( size() != 0)
+        {
+            last_level = Eytzinger::highBit(size());
+            last_level_size = size() - ((size_t(1) << last_level) - 1);
+        }
+    }
+
+    template <class T, class Compare>
+    template <class RandomAccessIterator>
+    void StaticSearchIndex<T, Compare>::build(RandomAccessIterator &cur, size_t node)
+    {
+        if (node >= tree.size()) return;
+
+        build(cur, 2 * node);
+        tree[node] = *cur++;
+        build(cur, 2 * node + 1);
+    }
+
+    /*
+     * In a perfect tree with all the levels full, the node j of depth d (node number 2^d + j) is preceded
+     * by (2j + 1) * 2^(last_level - d) - 1 nodes. The nodes of the last level take every other position
+     * from the start of such a tree, so those that are missing are subtracted
+     */
+    template <class T, class Compare>
+    size_t StaticSearchIndex<T, Compare>::rank(size_t node) const
+    {
+        if ( node == 0) return size(); // Node 0 stands for 'not found'
+
+        unsigned depth = Eytzinger::highBit(node);
+        size_t full_rank = ((2 * (node - (size_t(1) << depth)) + 1) << (last_level - depth)) - 1;
+        size_t last_before = (full_rank + 1) / 2; // Nodes of the full last level before this one
+
+        return full_rank - (last_before > last_level_size ? last_before - last_level_size : 0);
+    }
+
+    template <class T, class Compare>
+    template <class GoRight>
+    size_t StaticSearchIndex<T, Compare>::descend(GoRight go_right) const
+    {
+        // Descendants of node k four levels down occupy a cache line starting at k * 16 (4-byte elements)
+        const size_t prefetch_stride = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        const T *nodes = tree.data();
+        size_t num = tree.size();
+
+        size_t k = 1;
+        while (k < num)
+        {
+            ALG_PREFETCH(nodes + k * prefetch_stride);
+            k = 2 * k + (go_right(nodes[k]) ? 1 : 0);
+        }
+
+        // Undo the trailing right turns and the last left one
+        return k >> (Eytzinger::trailingOnes(k) + 1);
+    }
+
+    template <class T, class Compare>
+    size_t StaticSearchIndex<T, Compare>::lowerBound(const T &val) const
+    {
+        Compare &c = comp;
+        return rank( descend([&c, &val](const T &elem){ return c(elem, val); }));
+    }
+
+    template <class T, class Compare>
+    size_t StaticSearchIndex<T, Compare>::upperBound(const T &val) const
+    {
+        Compare &c = comp;
+        return rank( descend([&c, &val](const T &elem){ return !c(val, elem); }));
+    }
+
+    template <class T, class Compare>
+    size_t StaticSearchIndex<T, Compare>::find(const T &val) const
+    {
+        Compare &c = comp;
+        size_t k = descend([&c, &val](const T &elem){ return c(elem, val); });
+
+        if (k == 0 || comp(val, tree[k])) return size();
+        return rank(k);
+    }
+
+    template <class T, class Compare>
+    size_t StaticSearchIndex<T, Compare>::size() const
+    {
+        return tree.size() - 1;
+    }
+
+    bool uTestSearchIndex(UnitTest *utest_p);
+
+} /* namespace Alg */
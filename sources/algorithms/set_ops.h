@@ -0,0 +1,501 @@
+/**
+* @file: set_ops.h
+* Interface and implementation of the operations on sorted sets
+* @ingroup Algorithms
+* @brief Intersection, union and difference of sorted ranges with SIMD block kernels and galloping search
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+/* Block kernels for 32-bit keys: AVX2 if enabled at compile time, SSE2 on x86-64, none with ALG_SET_NO_SIMD */
+#if !defined(ALG_SET_NO_SIMD) && defined(__AVX2__)
+#    include <immintrin.h>
+#    define ALG_SET_AVX2
+#elif !defined(ALG_SET_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#    include <emmintrin.h>
+#    define ALG_SET_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+namespace Alg
+{
+    /* Helper routines of the set operations */
+    namespace SetOps
+    {
+        const size_t gallop_ratio = 32; // Size ratio above which the elements of the smaller range are searched for
+
+        /** Ranges of 32-bit unsigned keys in memory, they go to the block kernels with std::less */
+        template <class Iterator> struct IsPlainKey: std::false_type {};
+        template <> struct IsPlainKey<UInt32 *>: std::true_type {};
+        template <> struct IsPlainKey<const UInt32 *>: std::true_type {};
+        template <> struct IsPlainKey<std::vector<UInt32>::iterator>: std::true_type {};
+        template <> struct IsPlainKey<std::vector<UInt32>::const_iterator>: std::true_type {};
+
+        template <class Iterator1, class Iterator2, class Compare> struct UseKernel
+        {
+            static const bool value = IsPlainKey<Iterator1>::value && IsPlainKey<Iterator2>::value
+                                      && std::is_same<Compare, std::less<UInt32> >::value;
+            typedef std::integral_constant<bool, value> type;
+        };
+
+        /** Index of the lowest set bit of a non-zero mask */
+        inline unsigned lowestBit(unsigned mask)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+            unsigned long pos;
+            _BitScanForward(&pos, mask);
+            return pos;
+#else
+            unsigned pos = 0;
+            while ( !(mask & 1))
+            {
+                mask >>= 1;
+                pos++;
+            }
+            return pos;
+#endif
+        }
+
+        /**
+         * First position in [from, to) that is not less than the value. The step doubles from the start of
+         * the range until it overshoots, then the binary search finishes within the last step. Finding the
+         * element at distance d takes O(log d) comparisons, so searching for a sorted sequence of values costs
+         * O(n log(N / n)) in total
+         */
+        template <class RandomAccessIterator, class Value, class Compare>
+        RandomAccessIterator gallop(RandomAccessIterator from, RandomAccessIterator to, const Value &val, Compare &comp)
+        {
+            if ( from == to || !comp(*from, val)) return from;
+
+            size_t size = std::distance(from, to);
+            size_t less = 0; // from[less] is known to be less than the value
+            size_t step = 1;
+            while (step < size && comp(from[step], val))
+            {
+                less = step;
+                step *= 2;
+            }
+            return lowerBound(val, from + less + 1, from + std::min(step, size), comp);
+        }
+
+        /* Scalar merge-based operations, the same results as the std::set_* algorithms */
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator intersect(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                                 OutputIterator dst, Compare &comp, std::false_type use_kernel)
+        {
+            while (from1 != to1 && from2 != to2)
+            {
+                if ( comp(*from1, *from2)) ++from1;
+                else if ( comp(*from2, *from1)) ++from2;
+                else
+                {
+                    *dst++ = *from1++;
+                    ++from2;
+                }
+            }
+            return dst;
+        }
+
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator unite(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                             OutputIterator dst, Compare &comp, std::false_type use_kernel)
+        {
+            while (from1 != to1 && from2 != to2)
+            {
+                if ( comp(*from1, *from2)) *dst++ = *from1++;
+                else if ( comp(*from2, *from1)) *dst++ = *from2++;
+                else
+                {
+                    *dst++ = *from1++;
+                    ++from2;
+                }
+            }
+            dst = std::copy(from1, to1, dst);
+            return std::copy(from2, to2, dst);
+        }
+
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator subtract(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                                OutputIterator dst, Compare &comp, std::false_type use_kernel)
+        {
+            while (from1 != to1 && from2 != to2)
+            {
+                if ( comp(*from1, *from2)) *dst++ = *from1++;
+                else
+                {
+                    if ( !comp(*from2, *from1)) ++from1;
+                    ++from2;
+                }
+            }
+            return std::copy(from1, to1, dst);
+        }
+
+#if defined(ALG_SET_AVX2)
+        const size_t block = 8; // Keys compared at once by the kernels
+
+        /** Compare all pairs of a[0, 8) and b[0, 8): bit k of the result is set if a[k] is in b */
+        inline unsigned blockMatches(const UInt32 *a, const UInt32 *b)
+        {
+            __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(a));
+            __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(b));
+            __m256i vs = _mm256_permute2x128_si256(vb, vb, 1); // The halves of b swapped
+
+            // The rotations within the halves line up every element of a with all of b
+            __m256i eq = _mm256_or_si256(
+                _mm256_or_si256( _mm256_cmpeq_epi32(va, vb),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm256_or_si256( _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+            __m256i eq_swapped = _mm256_or_si256(
+                _mm256_or_si256( _mm256_cmpeq_epi32(va, vs),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm256_or_si256( _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(1, 0, 3, 2))),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(2, 1, 0, 3)))));
+            return _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_or_si256(eq, eq_swapped)));
+        }
+#elif defined(ALG_SET_SSE2)
+        const size_t block = 4; // Keys compared at once by the kernels
+
+        /** Compare all pairs of a[0, 4) and b[0, 4): bit k of the result is set if a[k] is in b */
+        inline unsigned blockMatches(const UInt32 *a, const UInt32 *b)
+        {
+            __m128i va = _mm_loadu_si128( reinterpret_cast<const __m128i *>(a));
+            __m128i vb = _mm_loadu_si128( reinterpret_cast<const __m128i *>(b));
+
+            // The rotations of b line up every element of a with all of b
+            __m128i eq = _mm_or_si128(
+                _mm_or_si128( _mm_cmpeq_epi32(va, vb),
+                              _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128( _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                              _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+            return _mm_movemask_ps( _mm_castsi128_ps(eq));
+        }
+#endif
+
+#if defined(ALG_SET_AVX2) || defined(ALG_SET_SSE2)
+        /**
+         * Block intersection: a block of each range is compared all against all, then the block with the smaller
+         * last key is replaced by the next one (both on a tie). Every pair of equal keys meets in some pair of
+         * blocks, the ranges are advanced to the first elements that are left for the scalar loop
+         */
+        template <class OutputIterator>
+        OutputIterator intersectBlocks(const UInt32 *&a, const UInt32 *a_end, const UInt32 *&b, const UInt32 *b_end,
+                                       OutputIterator dst)
+        {
+            while (static_cast<size_t>(a_end - a) >= block && static_cast<size_t>(b_end - b) >= block)
+            {
+                for (unsigned mask = blockMatches(a, b); mask != 0; mask &= mask - 1)
+                {
+                    *dst++ = a[lowestBit(mask)];
+                }
+                UInt32 a_last = a[block - 1];
+                UInt32 b_last = b[block - 1];
+                if ( a_last <= b_last) a += block;
+                if ( b_last <= a_last) b += block;
+            }
+            return dst;
+        }
+
+        /**
+         * Block difference: the same walk as the intersection, the matches of the current block of 'a' are
+         * collected until it is replaced and then the keys without a match are written out
+         */
+        template <class OutputIterator>
+        OutputIterator subtractBlocks(const UInt32 *&a, const UInt32 *a_end, const UInt32 *&b, const UInt32 *b_end,
+                                      OutputIterator dst)
+        {
+            const unsigned all = (1u << block) - 1;
+            unsigned matched = 0;
+
+            while (static_cast<size_t>(a_end - a) >= block && static_cast<size_t>(b_end - b) >= block)
+            {
+                matched |= blockMatches(a, b);
+                UInt32 a_last = a[block - 1];
+                UInt32 b_last = b[block - 1];
+                if ( a_last <= b_last)
+                {
+                    for (unsigned mask = ~matched & all; mask != 0; mask &= mask - 1)
+                    {
+                        *dst++ = a[lowestBit(mask)];
+                    }
+                    a += block;
+                    matched = 0;
+                }
+                if ( b_last <= a_last) b += block;
+            }
+
+            // Keys of the current block that have a match are dropped, the rest are checked against the tail of 'b'
+            if ( matched != 0)
+            {
+                for (size_t k = 0; k < block; k++)
+                {
+                    if ( matched & (1u << k)) continue;
+                    while (b != b_end && *b < a[k]) ++b;
+                    if ( b == b_end || a[k] < *b) *dst++ = a[k];
+                    else ++b;
+                }
+                a += block;
+            }
+            return dst;
+        }
+#endif
+
+        /* 32-bit keys in memory: the block kernels when available, then the scalar loop for the tails */
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator intersect(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                                 OutputIterator dst, Compare &comp, std::true_type use_kernel)
+        {
+            const UInt32 *a = &*from1;
+            const UInt32 *b = &*from2;
+            const UInt32 *a_end = a + (to1 - from1);
+            const UInt32 *b_end = b + (to2 - from2);
+#if defined(ALG_SET_AVX2) || defined(ALG_SET_SSE2)
+            dst = intersectBlocks(a, a_end, b, b_end, dst);
+#endif
+            return intersect(a, a_end, b, b_end, dst, comp, std::false_type());
+        }
+
+        /** The branches of the merge are replaced by the minimum and the advances by the comparison results */
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator unite(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                             OutputIterator dst, Compare &comp, std::true_type use_kernel)
+        {
+            const UInt32 *a = &*from1;
+            const UInt32 *b = &*from2;
+            const UInt32 *a_end = a + (to1 - from1);
+            const UInt32 *b_end = b + (to2 - from2);
+            while (a != a_end && b != b_end)
+            {
+                UInt32 x = *a;
+                UInt32 y = *b;
+                *dst++ = x < y ? x : y;
+                a += (x <= y);
+                b += (y <= x);
+            }
+            dst = std::copy(a, a_end, dst);
+            return std::copy(b, b_end, dst);
+        }
+
+        template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+        OutputIterator subtract(Iterator1 from1, Iterator1 to1, Iterator2 from2, Iterator2 to2,
+                                OutputIterator dst, Compare &comp, std::true_type use_kernel)
+        {
+            const UInt32 *a = &*from1;
+            const UInt32 *b = &*from2;
+            const UInt32 *a_end = a + (to1 - from1);
+            const UInt32 *b_end = b + (to2 - from2);
+#if defined(ALG_SET_AVX2) || defined(ALG_SET_SSE2)
+            dst = subtractBlocks(a, a_end, b, b_end, dst);
+#endif
+            return subtract(a, a_end, b, b_end, dst, comp, std::false_type());
+        }
+
+        /*
+         * Operations with a much smaller range: each of its elements is searched for in the bigger range by
+         * galloping from the position of the previous one. On equal elements the one of the first range is taken
+         */
+        template <class SmallIterator, class BigIterator, class OutputIterator, class Compare>
+        OutputIterator intersectGallop(SmallIterator small, SmallIterator small_end, BigIterator big, BigIterator big_end,
+                                       OutputIterator dst, Compare &comp, bool small_first)
+        {
+            for (; small != small_end; ++small)
+            {
+                big = gallop(big, big_end, *small, comp);
+                if ( big == big_end) break;
+                if ( !comp(*small, *big))
+                {
+                    *dst++ = small_first ? *small : *big;
+                    ++big;
+                }
+            }
+            return dst;
+        }
+
+        template <class SmallIterator, class BigIterator, class OutputIterator, class Compare>
+        OutputIterator uniteGallop(SmallIterator small, SmallIterator small_end, BigIterator big, BigIterator big_end,
+                                   OutputIterator dst, Compare &comp, bool small_first)
+        {
+            for (; small != small_end; ++small)
+            {
+                BigIterator pos = gallop(big, big_end, *small, comp);
+                dst = std::copy(big, pos, dst);
+                big = pos;
+                if ( big != big_end && !comp(*small, *big))
+                {
+                    *dst++ = small_first ? *small : *big;
+                    ++big;
+                } else
+                {
+                    *dst++ = *small;
+                }
+            }
+            return std::copy(big, big_end, dst);
+        }
+
+        /** Difference of a small range and a big one: the elements of the first one that are not found */
+        template <class SmallIterator, class BigIterator, class OutputIterator, class Compare>
+        OutputIterator subtractGallopBig(SmallIterator small, SmallIterator small_end, BigIterator big, BigIterator big_end,
+                                         OutputIterator dst, Compare &comp)
+        {
+            for (; small != small_end; ++small)
+            {
+                big = gallop(big, big_end, *small, comp);
+                if ( big == big_end) break;
+                if ( comp(*small, *big)) *dst++ = *small;
+                else ++big;
+            }
+            return std::copy(small, small_end, dst);
+        }
+
+        /** Difference of a big range and a small one: the runs of the first one between the removed elements */
+        template <class BigIterator, class SmallIterator, class OutputIterator, class Compare>
+        OutputIterator subtractGallopSmall(BigIterator big, BigIterator big_end, SmallIterator small, SmallIterator small_end,
+                                           OutputIterator dst, Compare &comp)
+        {
+            for (; small != small_end; ++small)
+            {
+                BigIterator pos = gallop(big, big_end, *small, comp);
+                dst = std::copy(big, pos, dst);
+                big = pos;
+                if ( big == big_end) break;
+                if ( !comp(*small, *big)) ++big;
+            }
+            return std::copy(big, big_end, dst);
+        }
+    } /* namespace SetOps */
+
+    /**
+     * Intersection of two sorted sets: the elements of [from1, to1) that are also in [from2, to2) go to dst.
+     * The ranges must be strictly increasing by comp (no repeated elements). Returns the end of the output.
+     * Ranges of very different sizes are intersected by galloping search of the elements of the smaller one.
+     * For 32-bit unsigned keys in memory ordered by std::less the blocks of the ranges are compared all
+     * against all with SSE2 or AVX2 (8 keys, when it is enabled at compile time), which avoids the
+     * mispredicted branches of the merge; ALG_SET_NO_SIMD leaves the scalar loop only
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator1>::value_type> >
+    OutputIterator setIntersect(RandomAccessIterator1 from1, RandomAccessIterator1 to1,
+                                RandomAccessIterator2 from2, RandomAccessIterator2 to2,
+                                OutputIterator dst, Compare comp = Compare())
+    {
+        size_t size1 = std::distance(from1, to1);
+        size_t size2 = std::distance(from2, to2);
+        if ( size1 == 0 || size2 == 0) return dst;
+
+        if ( size1 * SetOps::gallop_ratio < size2) return SetOps::intersectGallop(from1, to1, from2, to2, dst, comp, true);
+        if ( size2 * SetOps::gallop_ratio < size1) return SetOps::intersectGallop(from2, to2, from1, to1, dst, comp, false);
+
+        return SetOps::intersect(from1, to1, from2, to2, dst, comp,
+                                 typename SetOps::UseKernel<RandomAccessIterator1, RandomAccessIterator2, Compare>::type());
+    }
+
+    /**
+     * Union of two sorted sets, an element found in both ranges is taken from the first one. See setIntersect
+     * for the requirements; 32-bit keys are merged by a loop without branches
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator1>::value_type> >
+    OutputIterator setUnion(RandomAccessIterator1 from1, RandomAccessIterator1 to1,
+                            RandomAccessIterator2 from2, RandomAccessIterator2 to2,
+                            OutputIterator dst, Compare comp = Compare())
+    {
+        size_t size1 = std::distance(from1, to1);
+        size_t size2 = std::distance(from2, to2);
+        if ( size1 == 0) return std::copy(from2, to2, dst);
+        if ( size2 == 0) return std::copy(from1, to1, dst);
+
+        if ( size1 * SetOps::gallop_ratio < size2) return SetOps::uniteGallop(from1, to1, from2, to2, dst, comp, true);
+        if ( size2 * SetOps::gallop_ratio < size1) return SetOps::uniteGallop(from2, to2, from1, to1, dst, comp, false);
+
+        return SetOps::unite(from1, to1, from2, to2, dst, comp,
+                             typename SetOps::UseKernel<RandomAccessIterator1, RandomAccessIterator2, Compare>::type());
+    }
+
+    /**
+     * Difference of two sorted sets: the elements of [from1, to1) that are not in [from2, to2). See setIntersect
+     * for the requirements and the kernels
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator1>::value_type> >
+    OutputIterator setDifference(RandomAccessIterator1 from1, RandomAccessIterator1 to1,
+                                 RandomAccessIterator2 from2, RandomAccessIterator2 to2,
+                                 OutputIterator dst, Compare comp = Compare())
+    {
+        size_t size1 = std::distance(from1, to1);
+        size_t size2 = std::distance(from2, to2);
+        if ( size1 == 0) return dst;
+        if ( size2 == 0) return std::copy(from1, to1, dst);
+
+        if ( size1 * SetOps::gallop_ratio < size2) return SetOps::subtractGallopBig(from1, to1, from2, to2, dst, comp);
+        if ( size2 * SetOps::gallop_ratio < size1) return SetOps::subtractGallopSmall(from1, to1, from2, to2, dst, comp);
+
+        return SetOps::subtract(from1, to1, from2, to2, dst, comp,
+                                typename SetOps::UseKernel<RandomAccessIterator1, RandomAccessIterator2, Compare>::type());
+    }
+
+    /**
+     * Intersection of k sorted sets given as pairs of iterators. The sets are intersected from the smallest
+     * one up, so the intermediate result only shrinks and is galloped through the big sets
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void setIntersect(const std::vector<std::pair<RandomAccessIterator, RandomAccessIterator> > &sets,
+                      std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> &result,
+                      Compare comp = Compare())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type Value;
+
+        result.clear();
+        if ( sets.empty()) return;
+
+        std::vector<size_t> order(sets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&sets](size_t a, size_t b)
+        {
+            return std::distance(sets[a].first, sets[a].second) < std::distance(sets[b].first, sets[b].second);
+        });
+
+        const std::pair<RandomAccessIterator, RandomAccessIterator> &smallest = sets[order[0]];
+        if ( sets.size() == 1)
+        {
+            result.assign(smallest.first, smallest.second);
+            return;
+        }
+        result.reserve( std::distance(smallest.first, smallest.second));
+        setIntersect(smallest.first, smallest.second, sets[order[1]].first, sets[order[1]].second,
+                     std::back_inserter(result), comp);
+
+        std::vector<Value> next;
+        next.reserve(result.size());
+        for (size_t i = 2; i < order.size() && !result.empty(); i++)
+        {
+            next.clear();
+            setIntersect(result.begin(), result.end(), sets[order[i]].first, sets[order[i]].second,
+                         std::back_inserter(next), comp);
+            result.swap(next);
+        }
+    }
+
+    bool uTestSetOps(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -0,0 +1,290 @@
+/**
+* @file: shuffle.h
+* Interface and implementation of shuffling and sampling algorithms
+* @ingroup Algorithms
+* @brief Seedable Fisher-Yates shuffle, parallel MergeShuffle, partial shuffle and reservoir sampling
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <random>
+#include <thread>
+#include <atomic>
+
+namespace Alg
+{
+    /* Helper routines for shuffling */
+    namespace Shuffle
+    {
+        /** Uniform random number in [0, range): Lemire's method for our generator */
+        inline UInt64 boundedRandom(Xoshiro256 &rng, UInt64 range)
+        {
+            return rng.bounded(range);
+        }
+
+        /** Uniform random number in [0, range): standard distribution for any other generator */
+        template <class Rng>
+        UInt64 boundedRandom(Rng &rng, UInt64 range)
+        {
+            return std::uniform_int_distribution<UInt64>(0, range - 1)(rng);
+        }
+
+        /** Fisher-Yates shuffle of the range */
+        template <class RandomAccessIterator, class Rng>
+        void fisherYates(RandomAccessIterator from, RandomAccessIterator to, Rng &rng)
+        {
+            using std::swap;
+            for (UInt64 i = std::distance(from, to); i > 1; i--)
+            {
+                swap( *(from + (i - 1)), *(from + boundedRandom(rng, i)));
+            }
+        }
+
+        /**
+         * MergeShuffle merge (Bacher, Bodini, Hollender, Lumbroso) of the independently shuffled
+         * [from, middle) and [middle, to) into a uniformly shuffled sequence. Elements are picked from
+         * either side by a random bit, the rest is inserted by a Fisher-Yates style pass
+         */
+        template <class RandomAccessIterator>
+        void merge(RandomAccessIterator from, RandomAccessIterator middle, RandomAccessIterator to, Xoshiro256 &rng)
+        {
+            using std::swap;
+            UInt64 i = 0;
+            UInt64 j = std::distance(from, middle);
+            UInt64 n = std::distance(from, to);
+
+            while (true)
+            {
+                if ( rng.flip())
+                {
+                    if (j == n) break;
+                    swap( *(from + i), *(from + j));
+                    j++;
+                } else if (i == j)
+                {
+                    break;
+                }
+                i++;
+            }
+            for (; i < n; i++)
+            {
+                swap( *(from + i), *(from + rng.bounded(i + 1)));
+            }
+        }
+
+        /** Run tasks [0, num_tasks) on the given number of threads */
+        template <class Task>
+        void runParallel(size_t num_tasks, unsigned num_threads, Task task)
+        {
+            std::atomic<size_t> next(0);
+            auto worker = [&]()
+            {
+                for (size_t i = next++; i < num_tasks; i = next++) task(i);
+            };
+
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < std::min<size_t>(num_threads, num_tasks); t++) threads.emplace_back(worker);
+            worker();
+            for (std::thread &thread : threads) thread.join();
+        }
+
+        /** Runs the tasks on its own threads, see runParallel */
+        struct ThreadRunner
+        {
+            unsigned num_threads;
+
+            template <class Task> void operator()(size_t num_tasks, Task task) const
+            {
+                runParallel(num_tasks, num_threads, task);
+            }
+        };
+
+        /** Runs the tasks on the shared thread pool */
+        struct PoolRunner
+        {
+            template <class Task> void operator()(size_t num_tasks, Task task) const
+            {
+                ThreadPool::instance().parallelFor(num_tasks, task);
+            }
+        };
+
+        /**
+         * Parallel MergeShuffle: blocks of at least 'min_block' elements are shuffled independently, then
+         * merged pairwise level by level. Every block and every merge gets its own generator stream
+         * derived from 'rng' by jumps, so the result depends only on the seed and not on the thread count.
+         * The tasks of each level are run by 'run_tasks'
+         */
+        template <class RandomAccessIterator, class Runner>
+        void mergeShuffleWith(RandomAccessIterator from, RandomAccessIterator to, Xoshiro256 &rng,
+                              size_t min_block, Runner run_tasks)
+        {
+            size_t size = std::distance(from, to);
+            size_t num_blocks = 1;
+            while (num_blocks < 1024 && size / (2 * num_blocks) >= min_block) num_blocks *= 2;
+
+            auto bound = [&](size_t block) { return from + (size * block) / num_blocks; };
+
+            std::vector<Xoshiro256> gens;
+            for (size_t i = 0; i < 2 * num_blocks - 1; i++)
+            {
+                rng.jump();
+                gens.push_back(rng);
+            }
+            rng.jump(); // The caller's stream moves past all the streams used here
+
+            run_tasks(num_blocks, [&](size_t block)
+            {
+                fisherYates(bound(block), bound(block + 1), gens[block]);
+            });
+
+            size_t gen = num_blocks;
+            for (size_t step = 1; step < num_blocks; step *= 2)
+            {
+                size_t num_merges = num_blocks / (2 * step);
+                run_tasks(num_merges, [&, step, gen](size_t i)
+                {
+                    size_t block = 2 * step * i;
+                    merge(bound(block), bound(block + step), bound(block + 2 * step), gens[gen + i]);
+                });
+                gen += num_merges;
+            }
+        }
+
+        /** Parallel MergeShuffle on 'num_threads' threads of its own */
+        template <class RandomAccessIterator>
+        void mergeShuffle(RandomAccessIterator from, RandomAccessIterator to, Xoshiro256 &rng,
+                          unsigned num_threads, size_t min_block)
+        {
+            ThreadRunner runner = { num_threads };
+            mergeShuffleWith(from, to, rng, min_block, runner);
+        }
+    } /* namespace Shuffle */
+
+    /**
+     * Shuffle the elements. Uses the per-thread default generator seeded from std::random_device
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator>
+    void shuffle(RandomAccessIterator from, RandomAccessIterator to)
+    {
+        Shuffle::fisherYates(from, to, defaultRandomGenerator());
+    }
+
+    /**
+     * Shuffle the elements with the given generator. A seeded Xoshiro256 makes the shuffle reproducible,
+     * any standard generator (e.g. std::mt19937) works too
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class Rng>
+    void shuffle(RandomAccessIterator from, RandomAccessIterator to, Rng &rng)
+    {
+        Shuffle::fisherYates(from, to, rng);
+    }
+
+    /**
+     * Parallel shuffle for big arrays (MergeShuffle). Runs on 'num_threads' threads, all hardware threads by
+     * default. The result is reproducible for a seeded generator regardless of the number of threads
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator>
+    void mergeShuffle(RandomAccessIterator from, RandomAccessIterator to, Xoshiro256 &rng, unsigned num_threads = 0)
+    {
+        if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+        Shuffle::mergeShuffle(from, to, rng, num_threads, 1 << 16);
+    }
+
+    /**
+     * Shuffle under the execution policy with the given generator. The parallel policies run MergeShuffle
+     * (see mergeShuffle) on the shared ThreadPool for big arrays: the result is reproducible for a seeded
+     * generator regardless of the number of threads, but differs from the sequential shuffle
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    shuffle(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to, Xoshiro256 &rng)
+    {
+        const size_t min_block = 1 << 16;
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value
+             || static_cast<size_t>( std::distance(from, to)) < 2 * min_block )
+        {
+            Shuffle::fisherYates(from, to, rng);
+            return;
+        }
+        Shuffle::mergeShuffleWith(from, to, rng, min_block, Shuffle::PoolRunner());
+    }
+
+    /**
+     * Shuffle under the execution policy with any other generator. Only Xoshiro256 can be split into
+     * independent streams, so this one is always sequential
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator, class Rng>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    shuffle(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to, Rng &rng)
+    {
+        Shuffle::fisherYates(from, to, rng);
+    }
+
+    /**
+     * Shuffle under the execution policy with the per-thread default generator
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    shuffle(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to)
+    {
+        shuffle(policy, from, to, defaultRandomGenerator());
+    }
+
+    /**
+     * Partial shuffle: moves a uniformly random sample of k elements in random order to the front of the range.
+     * Takes O(k) time, returns the end of the sample
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class Rng>
+    RandomAccessIterator sample(RandomAccessIterator from, RandomAccessIterator to, size_t k, Rng &rng)
+    {
+        using std::swap;
+        UInt64 size = std::distance(from, to);
+        k = std::min<UInt64>(k, size);
+
+        for (UInt64 i = 0; i < k; i++)
+        {
+            swap( *(from + i), *(from + i + Shuffle::boundedRandom(rng, size - i)));
+        }
+        return from + k;
+    }
+
+    /**
+     * Reservoir sampling of k elements from a sequence of unknown length (single pass of input iterators).
+     * The sample is written to 'out', returns the number of sampled elements (less than k for short inputs)
+     * @ingroup Algorithms
+     */
+    template <class InputIterator, class RandomAccessIterator, class Rng>
+    size_t reservoirSample(InputIterator from, InputIterator to, RandomAccessIterator out, size_t k, Rng &rng)
+    {
+        UInt64 seen = 0;
+        for (; from != to; ++from, ++seen)
+        {
+            if (seen < k)
+            {
+                *(out + seen) = *from;
+            } else
+            {
+                UInt64 pos = Shuffle::boundedRandom(rng, seen + 1);
+                if (pos < k) *(out + pos) = *from;
+            }
+        }
+        return static_cast<size_t>( std::min<UInt64>(seen, k));
+    }
+
+    bool uTestShuffle(UnitTest *utest_p);
+
+} /* namespace Alg */
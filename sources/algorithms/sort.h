@@ -12,36 +12,16 @@
 #include <iterator>
 #include <algorithm>
 #include <utility>
-#include <random>
 
 namespace Alg
 {
-    /**
-     * Shuffle the elements
-     * @ingroup Algorithms
-     */
-    template <class RandomAccessIterator>
-    void shuffle(RandomAccessIterator from, RandomAccessIterator to)
-    {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-
-        for ( auto pos = from; pos != to; ++pos)
-        {
-            auto offset = std::distance(from, pos); // The current offset
-            std::uniform_int_distribution<> dis(0, offset);
-            decltype (offset) swap_offset = dis(gen);
-            std::swap(*(from + swap_offset), *pos);
-        }
-    }
-
     /**
      * Sort every n-th elemnt using insertion sort algorithm
      */
-    template <class RandomAccessIterator, class Compare = std::less<typename RandomAccessIterator::value_type> >
-    void nSort(typename RandomAccessIterator::difference_type step,
+    template <class RandomAccessIterator, class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void nSort(typename std::iterator_traits<RandomAccessIterator>::difference_type step,
                RandomAccessIterator from, RandomAccessIterator to,
-               Compare comp = std::less< typename RandomAccessIterator::value_type>())
+               Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
         auto dist = std::distance(from, to); // The max distance
         for ( decltype (dist) offset = 0;
@@ -55,7 +35,7 @@ namespace Alg
             {
                 auto prev = cur - 1;
                 if (comp(*cur, *prev))
-                    std::swap(*prev, *cur);
+                    std::iter_swap(prev, cur);
             }
         }
     }
@@ -64,8 +44,8 @@ namespace Alg
      * Sort elements between iterators using Shell's algorithm (with n_i = 3 * n_i + 1 step sequence)
      * @ingroup Algorithms
      */
-    template <class RandomAccessIterator, class Compare = std::less<typename RandomAccessIterator::value_type> >
-    void shellSort(RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less< typename RandomAccessIterator::value_type>())
+    template <class RandomAccessIterator, class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void shellSort(RandomAccessIterator from, RandomAccessIterator to, Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
         // Select the biggest step
         auto total_length = std::distance(from, to); // The max distance
@@ -93,17 +73,17 @@ namespace Alg
      * NOTE: the sequence at dst should be able to hold the merged sequence
      * @ingroup Algorithms
      */
-    template <class RandomAccessIterator, class Compare = std::less<typename RandomAccessIterator::value_type> >
+    template <class RandomAccessIterator, class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
     void merge(RandomAccessIterator from1, RandomAccessIterator to1, 
                RandomAccessIterator from2, RandomAccessIterator to2, 
                RandomAccessIterator dst, 
-               Compare comp = std::less< typename RandomAccessIterator::value_type>())
+               Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
         // while both seqeunces have the unmerged elements
         while (from1 != to1 && from2 != to2) 
         {
-            if (comp(*from1, *from2)) *dst++ = *from1++;
-            else *dst++ = *from2++;
+            if (comp(*from2, *from1)) *dst++ = *from2++;
+            else *dst++ = *from1++; // Equal elements are taken from the first sequence to keep the merge stable
         }
         
         if (from2 == to2) {
@@ -120,10 +100,10 @@ namespace Alg
     * @ingroup Algorithms
     */
     template <class RandomAccessIterator, 
-              class Compare = std::less<typename RandomAccessIterator::value_type> >
-    void mergeSortRecImpl(std::vector<typename RandomAccessIterator::value_type> &aux,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>, class Alloc>
+    void mergeSortRecImpl(std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type, Alloc> &aux,
                           RandomAccessIterator from, RandomAccessIterator to,
-                          Compare comp = std::less< typename RandomAccessIterator::value_type>())
+                          Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
         if ( std::distance(from, to) < 2) return;
         
@@ -145,23 +125,36 @@ namespace Alg
      * @ingroup Algorithms
      */
     template <class RandomAccessIterator, 
-              class Compare = std::less<typename RandomAccessIterator::value_type> >
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
     void mergeSort(RandomAccessIterator from, RandomAccessIterator to,
-                   Compare comp = std::less< typename RandomAccessIterator::value_type>())
+                   Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
-        std::vector<typename RandomAccessIterator::value_type> aux(std::distance(from, to));
+        std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> aux(std::distance(from, to));
         mergeSortRecImpl(aux, from, to, comp);
     }
 
+    /**
+     * Sort elements between iterators using merge sort algorithm, the auxiliary array is taken from the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void mergeSort(RandomAccessIterator from, RandomAccessIterator to, Workspace &ws,
+                   Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        mergeSortRecImpl(ws.buffer<T>( std::distance(from, to)), from, to, comp);
+    }
+
     /**
     * Sort elements between iterators using merge sort algorithm
     * @ingroup Algorithms
     */
     template <class RandomAccessIterator,
-    class Compare = std::less<typename RandomAccessIterator::value_type> >
-        void mergeSortBottomUpImpl(std::vector<typename RandomAccessIterator::value_type> &aux,
+    class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>, class Alloc>
+        void mergeSortBottomUpImpl(std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type, Alloc> &aux,
         RandomAccessIterator from, RandomAccessIterator to,
-        Compare comp = std::less< typename RandomAccessIterator::value_type>())
+        Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
         auto size = std::distance(from, to);
         for (decltype (size) step = 1; step < size; step *= 2)
@@ -196,14 +189,250 @@ namespace Alg
     * @ingroup Algorithms
     */
     template <class RandomAccessIterator,
-    class Compare = std::less<typename RandomAccessIterator::value_type> >
+    class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
         void mergeSortBU(RandomAccessIterator from, RandomAccessIterator to,
-        Compare comp = std::less< typename RandomAccessIterator::value_type>())
+        Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
     {
-        std::vector<typename RandomAccessIterator::value_type> aux(std::distance(from, to));
+        std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> aux(std::distance(from, to));
         mergeSortBottomUpImpl(aux, from, to, comp);
     }
 
+    /**
+    * Sort elements between iterators using merge sort algorithm (bottom up version),
+    * the auxiliary array is taken from the workspace
+    * @ingroup Algorithms
+    */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void mergeSortBU(RandomAccessIterator from, RandomAccessIterator to, Workspace &ws,
+                     Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        mergeSortBottomUpImpl(ws.buffer<T>( std::distance(from, to)), from, to, comp);
+    }
+
+    /* Helper routines for merging with a bounded buffer */
+    namespace Merge
+    {
+        /**
+         * Stable insertion sort of a short run. Unlike insertionSort it shifts the elements
+         * and stops as soon as the inserted element reaches its place
+         */
+        template <class RandomAccessIterator, class Compare>
+        void insertionSortRun(RandomAccessIterator from, RandomAccessIterator to, Compare &comp)
+        {
+            if (from == to) return;
+
+            for (auto pos = from + 1; pos != to; ++pos)
+            {
+                auto val = std::move(*pos);
+                auto cur = pos;
+                for (; cur != from && comp(val, *(cur - 1)); --cur)
+                {
+                    *cur = std::move(*(cur - 1));
+                }
+                *cur = std::move(val);
+            }
+        }
+
+        /**
+         * Stable merge of the adjacent sorted sequences [from, middle) and [middle, to) in place.
+         * The buffer of 'buf_size' elements is used when the shorter sequence fits into it,
+         * otherwise the sequences are split by binary search and the middle parts are swapped by rotation
+         */
+        template <class RandomAccessIterator, class BufferIterator, class Compare>
+        void mergeAdaptive(RandomAccessIterator from, RandomAccessIterator middle, RandomAccessIterator to,
+                           BufferIterator buf, size_t buf_size, Compare &comp)
+        {
+            while (true)
+            {
+                size_t len1 = std::distance(from, middle);
+                size_t len2 = std::distance(middle, to);
+
+                if (len1 == 0 || len2 == 0) return;
+                if ( !comp(*middle, *(middle - 1)) ) return; // Sequences are already in order
+
+                if (len1 + len2 == 2)
+                {
+                    std::iter_swap(from, middle);
+                    return;
+                }
+
+                if (len1 <= len2 && len1 <= buf_size)
+                {
+                    // Move the first sequence to the buffer and merge forward
+                    auto buf_end = std::move(from, middle, buf);
+                    auto dst = from;
+                    while (buf != buf_end && middle != to)
+                    {
+                        if (comp(*middle, *buf)) *dst++ = std::move(*middle++);
+                        else *dst++ = std::move(*buf++);
+                    }
+                    std::move(buf, buf_end, dst);
+                    return;
+                }
+
+                if (len2 <= buf_size)
+                {
+                    // Move the second sequence to the buffer and merge backward
+                    auto buf_end = std::move(middle, to, buf);
+                    auto dst = to;
+                    while (buf != buf_end && from != middle)
+                    {
+                        if (comp(*(buf_end - 1), *(middle - 1))) *--dst = std::move(*--middle);
+                        else *--dst = std::move(*--buf_end);
+                    }
+                    std::move_backward(buf, buf_end, dst);
+                    return;
+                }
+
+                // Split the longer sequence in half and find the matching cut in the other one
+                RandomAccessIterator cut1, cut2;
+                if (len1 > len2)
+                {
+                    cut1 = from + len1 / 2;
+                    cut2 = std::lower_bound(middle, to, *cut1, comp);
+                } else
+                {
+                    cut2 = middle + len2 / 2;
+                    cut1 = std::upper_bound(from, middle, *cut2, comp);
+                }
+                auto new_middle = std::rotate(cut1, middle, cut2);
+
+                // Recurse into the left part, loop on the right one
+                mergeAdaptive(from, cut1, new_middle, buf, buf_size, comp);
+                from = new_middle;
+                middle = cut2;
+            }
+        }
+
+        /** Merge sort with the buffer of 'buf_size' elements, see mergeSortBuffered */
+        template <class RandomAccessIterator, class BufferIterator, class Compare>
+        void sortBuffered(RandomAccessIterator from, RandomAccessIterator to,
+                          BufferIterator buf, size_t buf_size, Compare &comp)
+        {
+            const size_t run_size = 16; // Length of the runs sorted by insertion sort
+
+            size_t size = std::distance(from, to);
+            if (size < 2) return;
+
+            for (size_t cur = 0; cur < size; cur += run_size)
+            {
+                insertionSortRun(from + cur, from + std::min(cur + run_size, size), comp);
+            }
+
+            for (size_t step = run_size; step < size; step *= 2)
+            {
+                for (size_t cur = 0; cur + step < size; cur += 2 * step)
+                {
+                    mergeAdaptive(from + cur, from + cur + step, from + std::min(cur + 2 * step, size),
+                                  buf, buf_size, comp);
+                }
+            }
+        }
+    } /* namespace Merge */
+
+    /**
+     * Stable merge sort that uses at most 'buffer_size' elements of extra memory. Any budget works:
+     * with zero buffer the runs are merged by rotations in O(n log^2 n) time, a buffer of sqrt(n)
+     * elements already handles all the short merges directly, a buffer of n/2 elements gives a classic merge sort
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void mergeSortBuffered(RandomAccessIterator from, RandomAccessIterator to, size_t buffer_size,
+                           Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        // No merge ever needs more than half of the sequence in the buffer
+        size_t buf_size = std::min<size_t>(buffer_size, std::distance(from, to) / 2);
+        std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> buf(buf_size);
+
+        Merge::sortBuffered(from, to, buf.begin(), buf_size, comp);
+    }
+
+    /**
+     * Stable merge sort that uses at most 'buffer_size' elements of extra memory taken from the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void mergeSortBuffered(RandomAccessIterator from, RandomAccessIterator to, size_t buffer_size, Workspace &ws,
+                           Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        size_t buf_size = std::min<size_t>(buffer_size, std::distance(from, to) / 2);
+
+        Merge::sortBuffered(from, to, ws.buffer<T>(buf_size).begin(), buf_size, comp);
+    }
+
+    /**
+     * Merge two sorted sequences under the execution policy. The parallel policies merge blocks
+     * of the output on the shared ThreadPool, the result is the same as of the sequential merge
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    merge(const ExecutionPolicy &policy,
+          RandomAccessIterator from1, RandomAccessIterator to1,
+          RandomAccessIterator from2, RandomAccessIterator to2,
+          RandomAccessIterator dst,
+          Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        size_t size1 = std::distance(from1, to1);
+        size_t size2 = std::distance(from2, to2);
+
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value || size1 + size2 < 2 * Parallel::merge_block)
+        {
+            merge(from1, to1, from2, to2, dst, comp);
+            return;
+        }
+        Parallel::merge(from1, size1, from2, size2, dst, comp, ThreadPool::instance());
+    }
+
+    /**
+     * Merge sort under the execution policy. The parallel policies sort chunks on the shared ThreadPool
+     * and merge them in parallel
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    mergeSort(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to,
+              Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value)
+        {
+            mergeSort(from, to, comp);
+            return;
+        }
+        Parallel::sortMerge(from, to, comp, [comp](RandomAccessIterator first, RandomAccessIterator last)
+        {
+            mergeSort(first, last, comp);
+        });
+    }
+
+    /**
+     * Bottom up merge sort under the execution policy, see mergeSort
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    mergeSortBU(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to,
+                Compare comp = std::less< typename std::iterator_traits<RandomAccessIterator>::value_type>())
+    {
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value)
+        {
+            mergeSortBU(from, to, comp);
+            return;
+        }
+        Parallel::sortMerge(from, to, comp, [comp](RandomAccessIterator first, RandomAccessIterator last)
+        {
+            mergeSortBU(first, last, comp);
+        });
+    }
+
     bool uTestSort(UnitTest *utest_p);
     bool uTestHeap(UnitTest *utest_p);
 
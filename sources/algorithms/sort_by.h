@@ -0,0 +1,478 @@
+/**
+* @file: sort_by.h
+* Interface and implementation of key-projection sorting
+* @ingroup Algorithms
+* @brief Sorting by a projected key: keys are extracted once, sorted compactly and the permutation is applied in place
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+#include <array>
+
+namespace Alg
+{
+    /* Helper routines for sorting by projected keys */
+    namespace SortBy
+    {
+        /** Type of the key produced by the projection function */
+        template <class RandomAccessIterator, class KeyFn> struct KeyOf
+        {
+            typedef typename std::decay<
+                decltype( std::declval<KeyFn&>()( *std::declval<RandomAccessIterator>()))>::type type;
+        };
+
+        /** Cached key of an element along with the element's original position */
+        template <class Key> struct KeyIndex
+        {
+            Key key;
+            size_t index;
+        };
+
+        /**
+         * Compare cached keys. Ties are broken by the original position,
+         * so every sorting engine applied to the keys yields a stable order
+         */
+        template <class Key, class Compare> struct KeyIndexLess
+        {
+            Compare comp;
+
+            KeyIndexLess(Compare c): comp(c){}
+
+            bool operator()(const KeyIndex<Key> &a, const KeyIndex<Key> &b)
+            {
+                if ( comp(a.key, b.key) ) return true;
+                if ( comp(b.key, a.key) ) return false;
+                return a.index < b.index;
+            }
+        };
+
+        /** Extract (key, index) pairs of the range into a compact array, the array keeps its capacity */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Alloc>
+        void extractKeys(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn,
+                         std::vector< KeyIndex<Key>, Alloc > &keys)
+        {
+            keys.clear();
+            keys.reserve( std::distance(from, to));
+
+            size_t index = 0;
+            for (auto pos = from; pos != to; ++pos)
+            {
+                KeyIndex<Key> item = { key_fn(*pos), index++ };
+                keys.push_back(item);
+            }
+        }
+
+        /**
+         * Move the elements so that position i receives the element from position keys[i].index.
+         * Follows the cycles of the permutation, every element is moved exactly once (plus one
+         * temporary per cycle). The index fields are used as 'done' marks and are destroyed.
+         */
+        template <class RandomAccessIterator, class Key, class Alloc>
+        void applyPermutation(RandomAccessIterator from, std::vector< KeyIndex<Key>, Alloc > &keys)
+        {
+            for (size_t start = 0; start < keys.size(); start++)
+            {
+                if ( keys[start].index == start) continue; // Already in place or cycle is done
+
+                auto tmp = std::move( *(from + start));
+                size_t cur = start;
+
+                while (true)
+                {
+                    size_t src = keys[cur].index;
+                    keys[cur].index = cur; // Mark position as done
+
+                    if (src == start)
+                    {
+                        *(from + cur) = std::move(tmp);
+                        break;
+                    }
+                    *(from + cur) = std::move( *(from + src));
+                    cur = src;
+                }
+            }
+        }
+
+        /**
+         * Mapping of radix-sortable keys to unsigned bits that preserve the order of the keys.
+         * Defined for integral keys but bool and for float/double
+         */
+        template <class Key, bool is_integral = std::is_integral<Key>::value> struct RadixTraits
+        {
+            static const bool sortable = false;
+        };
+
+        template <class Key> struct RadixTraits<Key, true>
+        {
+            static const bool sortable = true;
+            typedef typename std::make_unsigned<Key>::type Bits;
+
+            static Bits bits(Key key)
+            {
+                Bits bits = static_cast<Bits>(key);
+                if ( std::numeric_limits<Key>::is_signed)
+                {
+                    bits ^= Bits(1) << (std::numeric_limits<Bits>::digits - 1); // flip the sign bit
+                }
+                return bits;
+            }
+        };
+
+        /**
+         * Floating point keys: flip all bits of negative numbers and the sign bit of positive ones.
+         * -0.0 is mapped as +0.0, the two are equal under std::less
+         */
+        template <class Key, class UInt> struct RadixFloatTraits
+        {
+            static const bool sortable = true;
+            typedef UInt Bits;
+
+            static Bits bits(Key key)
+            {
+                static_assert( sizeof(Key) == sizeof(Bits), "Floating point type size mismatch");
+                if ( key == 0) key = 0;
+
+                Bits bits;
+                std::memcpy(&bits, &key, sizeof(bits));
+
+                const Bits sign = Bits(1) << (std::numeric_limits<Bits>::digits - 1);
+                return (bits & sign) ? ~bits : (bits ^ sign);
+            }
+        };
+
+        /** A bool has no unsigned counterpart and only two values, it is not worth a radix pass */
+        template <> struct RadixTraits<bool, true>
+        {
+            static const bool sortable = false;
+        };
+
+        template <> struct RadixTraits<float, false>: RadixFloatTraits<float, UInt32>{};
+        template <> struct RadixTraits<double, false>: RadixFloatTraits<double, UInt64>{};
+
+        /** Map a key to unsigned bits that preserve the order of the keys */
+        template <class Key>
+        typename RadixTraits<Key>::Bits radixBits(Key key)
+        {
+            return RadixTraits<Key>::bits(key);
+        }
+
+        /** Whether the projected keys are sorted on the radix path: the radix-sortable integral keys */
+        template <class Key> struct RadixKey:
+            std::integral_constant<bool, std::is_integral<Key>::value && RadixTraits<Key>::sortable>{};
+
+        /** One counting pass of the LSD radix sort from the source sequence to the destination */
+        template <class SrcIterator, class DstIterator, class Counts, class BitsOf>
+        void radixPass(SrcIterator from, SrcIterator to, DstIterator dst,
+                       Counts &count, unsigned shift, BitsOf &bits_of)
+        {
+            const size_t mask = count.size() - 1;
+
+            // Convert counts to start positions
+            size_t sum = 0;
+            for (size_t &c : count)
+            {
+                size_t tmp = c;
+                c = sum;
+                sum += tmp;
+            }
+
+            for (auto pos = from; pos != to; ++pos)
+            {
+                *(dst + count[ (bits_of(*pos) >> shift) & mask]++) = std::move(*pos);
+            }
+        }
+
+        /**
+         * LSD radix sort (8 bits per pass) of the elements by the unsigned bits returned by 'bits_of'.
+         * The sort is stable. Passes where all elements share the digit are skipped.
+         * 'aux' is the scratch array, it is enlarged to the size of the sequence if needed
+         */
+        template <class RandomAccessIterator, class BitsOf, class Alloc>
+        void radixSort(RandomAccessIterator from, RandomAccessIterator to, BitsOf bits_of,
+                       std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type, Alloc> &aux_buf)
+        {
+            typedef typename std::decay< decltype( bits_of( *from))>::type Bits;
+
+            const unsigned digit_bits = 8;
+            const size_t mask = (size_t(1) << digit_bits) - 1;
+
+            size_t size = std::distance(from, to);
+            if ( size < 2) return;
+
+            auto aux = Scratch::fit(aux_buf, size).begin();
+            auto aux_end = aux + size;
+            std::array<size_t, mask + 1> count;
+            bool in_place = true; // Whether the current order is in the original sequence or in aux
+
+            for (unsigned shift = 0; shift < std::numeric_limits<Bits>::digits; shift += digit_bits)
+            {
+                std::fill(count.begin(), count.end(), 0);
+                if ( in_place)
+                {
+                    for (auto pos = from; pos != to; ++pos) count[ (bits_of(*pos) >> shift) & mask]++;
+                } else
+                {
+                    for (auto pos = aux; pos != aux_end; ++pos) count[ (bits_of(*pos) >> shift) & mask]++;
+                }
+
+                // All elements have the same digit - nothing to do on this pass
+                if ( count[ (bits_of(in_place ? *from : *aux) >> shift) & mask] == size) continue;
+
+                if ( in_place)
+                {
+                    radixPass(from, to, aux, count, shift, bits_of);
+                } else
+                {
+                    radixPass(aux, aux_end, from, count, shift, bits_of);
+                }
+                in_place = !in_place;
+            }
+
+            if ( !in_place) std::move(aux, aux_end, from);
+        }
+
+        /** LSD radix sort with its own scratch array */
+        template <class RandomAccessIterator, class BitsOf>
+        void radixSort(RandomAccessIterator from, RandomAccessIterator to, BitsOf bits_of)
+        {
+            std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> aux;
+            radixSort(from, to, bits_of, aux);
+        }
+
+        /** Merge sort of the cached keys, 'keys' and 'aux' are the scratch arrays */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Compare, class Alloc>
+        void mergeSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn &key_fn, Compare &comp,
+                         std::vector< KeyIndex<Key>, Alloc > &keys, std::vector< KeyIndex<Key>, Alloc > &aux)
+        {
+            extractKeys(from, to, key_fn, keys);
+            mergeSortRecImpl(Scratch::fit(aux, keys.size()), keys.begin(), keys.end(), KeyIndexLess<Key, Compare>(comp));
+            applyPermutation(from, keys);
+        }
+
+        /** Shell sort of the cached keys, 'keys' is the scratch array */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Compare, class Alloc>
+        void shellSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn &key_fn, Compare &comp,
+                         std::vector< KeyIndex<Key>, Alloc > &keys)
+        {
+            extractKeys(from, to, key_fn, keys);
+            shellSort(keys.begin(), keys.end(), KeyIndexLess<Key, Compare>(comp));
+            applyPermutation(from, keys);
+        }
+
+        /** Radix sort of the cached integral keys, 'keys' and 'aux' are the scratch arrays */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Alloc>
+        void radixSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn &key_fn,
+                         std::vector< KeyIndex<Key>, Alloc > &keys, std::vector< KeyIndex<Key>, Alloc > &aux)
+        {
+            static_assert( RadixKey<Key>::value, "radixSortBy requires a radix-sortable integral key");
+
+            extractKeys(from, to, key_fn, keys);
+            radixSort(keys.begin(), keys.end(), [](const KeyIndex<Key> &item){ return radixBits(item.key); }, aux);
+            applyPermutation(from, keys);
+        }
+    } /* namespace SortBy */
+
+    /**
+     * Sort elements by the key projected by 'key_fn' using merge sort. Keys are computed once per element,
+     * the (key, index) array is sorted and the resulting permutation is applied in place. The sort is stable.
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn,
+              class Compare = std::less< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> >
+    void mergeSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn,
+                     Compare comp = Compare())
+    {
+        typedef typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type Key;
+
+        std::vector< SortBy::KeyIndex<Key> > keys, aux;
+        SortBy::mergeSortBy(from, to, key_fn, comp, keys, aux);
+    }
+
+    /**
+     * Merge sort by the projected key with the scratch arrays taken from the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn,
+              class Compare = std::less< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> >
+    void mergeSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Workspace &ws,
+                     Compare comp = Compare())
+    {
+        typedef SortBy::KeyIndex< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> Item;
+
+        SortBy::mergeSortBy(from, to, key_fn, comp, ws.buffer<Item>(0, 0), ws.buffer<Item>(0, 1));
+    }
+
+    /**
+     * Sort elements by the key projected by 'key_fn' using Shell's algorithm on the cached keys.
+     * Keys are tie-broken by position so the result is stable as well.
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn,
+              class Compare = std::less< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> >
+    void shellSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn,
+                     Compare comp = Compare())
+    {
+        typedef typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type Key;
+
+        std::vector< SortBy::KeyIndex<Key> > keys;
+        SortBy::shellSortBy(from, to, key_fn, comp, keys);
+    }
+
+    /**
+     * Shell sort by the projected key with the cached keys kept in the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn,
+              class Compare = std::less< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> >
+    void shellSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Workspace &ws,
+                     Compare comp = Compare())
+    {
+        typedef SortBy::KeyIndex< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> Item;
+
+        SortBy::shellSortBy(from, to, key_fn, comp, ws.buffer<Item>(0));
+    }
+
+    /**
+     * Sort elements by an integral key projected by 'key_fn' using LSD radix sort of the cached keys.
+     * The sort is stable.
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn>
+    void radixSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn)
+    {
+        typedef typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type Key;
+
+        std::vector< SortBy::KeyIndex<Key> > keys, aux;
+        SortBy::radixSortBy(from, to, key_fn, keys, aux);
+    }
+
+    /**
+     * Radix sort by the projected integral key with the scratch arrays taken from the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn>
+    void radixSortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Workspace &ws)
+    {
+        typedef SortBy::KeyIndex< typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type> Item;
+
+        SortBy::radixSortBy(from, to, key_fn, ws.buffer<Item>(0, 0), ws.buffer<Item>(0, 1));
+    }
+
+    namespace SortBy
+    {
+        /** Route to the radix path for radix-sortable integral keys */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Alloc>
+        void sortByDispatch(RandomAccessIterator from, RandomAccessIterator to, KeyFn &key_fn,
+                            std::vector< KeyIndex<Key>, Alloc > &keys, std::vector< KeyIndex<Key>, Alloc > &aux,
+                            std::true_type radix_key)
+        {
+            radixSortBy(from, to, key_fn, keys, aux);
+        }
+
+        /** Route to merge sort for all other keys */
+        template <class RandomAccessIterator, class KeyFn, class Key, class Alloc>
+        void sortByDispatch(RandomAccessIterator from, RandomAccessIterator to, KeyFn &key_fn,
+                            std::vector< KeyIndex<Key>, Alloc > &keys, std::vector< KeyIndex<Key>, Alloc > &aux,
+                            std::false_type radix_key)
+        {
+            std::less<Key> comp;
+            mergeSortBy(from, to, key_fn, comp, keys, aux);
+        }
+    } /* namespace SortBy */
+
+    /**
+     * Stable sort of elements by the key projected by 'key_fn' in ascending order.
+     * Integral keys other than bool are routed to the radix path, other keys are sorted with merge sort
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn>
+    void sortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn)
+    {
+        typedef typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type Key;
+
+        std::vector< SortBy::KeyIndex<Key> > keys, aux;
+        SortBy::sortByDispatch(from, to, key_fn, keys, aux, typename SortBy::RadixKey<Key>::type());
+    }
+
+    /**
+     * Stable sort by the projected key in ascending order with the scratch arrays taken from the workspace
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn>
+    void sortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Workspace &ws)
+    {
+        typedef typename SortBy::KeyOf<RandomAccessIterator, KeyFn>::type Key;
+        typedef SortBy::KeyIndex<Key> Item;
+
+        SortBy::sortByDispatch(from, to, key_fn, ws.buffer<Item>(0, 0), ws.buffer<Item>(0, 1),
+                               typename SortBy::RadixKey<Key>::type());
+    }
+
+    /**
+     * Stable sort of elements by the key projected by 'key_fn' with a custom key comparison
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator, class KeyFn, class Compare>
+    void sortBy(RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Compare comp)
+    {
+        mergeSortBy(from, to, key_fn, comp);
+    }
+
+    /**
+     * Stable sort by the projected key with a custom key comparison under the execution policy. The parallel
+     * policies sort chunks with sortBy on the shared ThreadPool and merge them in parallel
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator, class KeyFn, class Compare>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    sortBy(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn, Compare comp)
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value)
+        {
+            sortBy(from, to, key_fn, comp);
+            return;
+        }
+        auto item_comp = [key_fn, comp](const T &a, const T &b) -> bool { return comp( key_fn(a), key_fn(b)); };
+        Parallel::sortMerge(from, to, item_comp, [key_fn, comp](RandomAccessIterator first, RandomAccessIterator last)
+        {
+            sortBy(first, last, key_fn, comp);
+        });
+    }
+
+    /**
+     * Stable sort by the projected key in ascending order under the execution policy
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class RandomAccessIterator, class KeyFn>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    sortBy(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to, KeyFn key_fn)
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value)
+        {
+            sortBy(from, to, key_fn);
+            return;
+        }
+        auto item_comp = [key_fn](const T &a, const T &b) -> bool { return key_fn(a) < key_fn(b); };
+        Parallel::sortMerge(from, to, item_comp, [key_fn](RandomAccessIterator first, RandomAccessIterator last)
+        {
+            sortBy(first, last, key_fn);
+        });
+    }
+
+    bool uTestSortBy(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -0,0 +1,378 @@
+/**
+* @file: sort_dispatch.h
+* Interface and implementation of the sorting front end
+* @ingroup Algorithms
+* @brief Alg::sort picks the sorting engine by value type, size, presortedness and stability requirement
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <array>
+
+namespace Alg
+{
+    /** Whether the sort must keep the original order of equal elements */
+    enum SortStability { NotStable, Stable };
+
+    /**
+     * Size thresholds used by the sort dispatcher. Defaults are typical crossover points of the engines on
+     * 32-bit keys, they can be adjusted for the machine at hand through sortThresholds(); the 'dispatch'
+     * benchmark suite reports the crossover points it measures next to the current values
+     * @ingroup Algorithms
+     */
+    struct SortThresholds
+    {
+        size_t insertion_max; /**< Sequences up to this size are sorted by insertion sort                 */
+        size_t radix_min;     /**< Arithmetic values from this size on are sorted by radix sort            */
+        size_t runs_ratio;    /**< Inputs with less than size/runs_ratio monotone runs are merged naturally  */
+        size_t radix_runs_max;/**< Radix sortable inputs are merged naturally only up to this number of runs */
+
+        SortThresholds(): insertion_max(64), radix_min(128), runs_ratio(16), radix_runs_max(4){}
+    };
+
+    /**
+     * Thresholds used by Alg::sort
+     * @ingroup Algorithms
+     */
+    inline SortThresholds &sortThresholds()
+    {
+        static SortThresholds thresholds;
+        return thresholds;
+    }
+
+    /* Helper routines of the sort dispatcher */
+    namespace SortDispatch
+    {
+        /** Order produced by a comparison, radix sort is used only for the well-known ones */
+        enum RadixOrder { NoRadix, Ascending, Descending };
+
+        template <class T, RadixOrder order> struct RadixOrderIf
+        {
+            static const RadixOrder value = SortBy::RadixTraits<T>::sortable ? order : NoRadix;
+        };
+
+        template <class T, class Compare> struct RadixOrderOf: RadixOrderIf<T, NoRadix>{};
+        template <class T> struct RadixOrderOf<T, std::less<T> >: RadixOrderIf<T, Ascending>{};
+        template <class T> struct RadixOrderOf<T, std::greater<T> >: RadixOrderIf<T, Descending>{};
+#if __cplusplus >= 201402L || defined(_MSC_VER)
+        template <class T> struct RadixOrderOf<T, std::less<> >: RadixOrderIf<T, Ascending>{};
+        template <class T> struct RadixOrderOf<T, std::greater<> >: RadixOrderIf<T, Descending>{};
+#endif
+
+        /**
+         * Return type of the built-in array overload, keeps it out of the overload set when the second
+         * argument is the end pointer of the array rather than a comparison
+         */
+        template <class Compare, class T, class R = void>
+        struct EnableIfComparison: std::enable_if< !std::is_convertible<Compare, const T *>::value, R> {};
+
+        /**
+         * Count the monotone (non-descending or strictly descending) runs of the sequence,
+         * counting stops once 'limit' runs are found
+         */
+        template <class RandomAccessIterator, class Compare>
+        size_t countRuns(RandomAccessIterator from, RandomAccessIterator to, size_t limit, Compare &comp)
+        {
+            size_t runs = 0;
+            for (auto cur = from; cur != to && runs < limit; )
+            {
+                runs++;
+                auto next = cur + 1;
+                if (next == to) break;
+
+                if ( comp(*next, *cur) )
+                {
+                    while (next != to && comp(*next, *(next - 1))) ++next;
+                } else
+                {
+                    while (next != to && !comp(*next, *(next - 1))) ++next;
+                }
+                cur = next;
+            }
+            return runs;
+        }
+
+        /**
+         * Find the end of the run starting at 'from'. Descending runs are reversed to become ascending,
+         * equal elements are reversed along with them only if the sort is not stable
+         */
+        template <class RandomAccessIterator, class Compare>
+        RandomAccessIterator makeRun(RandomAccessIterator from, RandomAccessIterator to,
+                                     SortStability stability, Compare &comp)
+        {
+            auto cur = from + 1;
+            if (cur == to) return to;
+
+            if ( comp(*cur, *from) )
+            {
+                // Descending run
+                while (cur != to)
+                {
+                    if ( comp(*cur, *(cur - 1)) ) ++cur;
+                    else if ( stability == NotStable && !comp(*(cur - 1), *cur)) ++cur;
+                    else break;
+                }
+                std::reverse(from, cur);
+            } else
+            {
+                while (cur != to && !comp(*cur, *(cur - 1))) ++cur;
+            }
+            return cur;
+        }
+
+        /**
+         * Natural merge sort: splits the sequence into the existing runs and merges adjacent runs
+         * pairwise. Takes O(n log r) time for r runs. 'bounds' and 'buf' are the scratch arrays
+         */
+        template <class RandomAccessIterator, class Compare, class BoundsAlloc, class Alloc>
+        void naturalMergeSort(RandomAccessIterator from, RandomAccessIterator to,
+                              SortStability stability, Compare &comp,
+                              std::vector<RandomAccessIterator, BoundsAlloc> &bounds,
+                              std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type, Alloc> &buf)
+        {
+            bounds.assign( 1, from);
+            for (auto cur = from; cur != to; )
+            {
+                cur = makeRun(cur, to, stability, comp);
+                bounds.push_back(cur);
+            }
+
+            size_t buf_size = std::distance(from, to) / 2 + 1;
+            Scratch::fit(buf, buf_size);
+
+            while ( bounds.size() > 2)
+            {
+                size_t last = 0;
+                for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+                {
+                    Merge::mergeAdaptive(bounds[i], bounds[i + 1], bounds[i + 2], buf.begin(), buf_size, comp);
+                    bounds[last++] = bounds[i];
+                }
+                if ( bounds.size() % 2 == 0) bounds[last++] = bounds[bounds.size() - 2]; // Odd run stays as is
+                bounds[last++] = bounds.back();
+                bounds.resize(last);
+            }
+        }
+
+        /** Whether the range holds a NaN, which std::less takes as equivalent to any value */
+        template <class RandomAccessIterator>
+        bool hasNaN(RandomAccessIterator from, RandomAccessIterator to, std::true_type is_floating)
+        {
+            for (; from != to; ++from)
+            {
+                if ( *from != *from) return true;
+            }
+            return false;
+        }
+
+        template <class RandomAccessIterator>
+        bool hasNaN(RandomAccessIterator from, RandomAccessIterator to, std::false_type is_floating)
+        {
+            return false;
+        }
+
+        /** Radix sort of arithmetic values in the given order, 'aux' is the scratch array */
+        template <class RandomAccessIterator, class T, class Alloc>
+        void radixSortValues(RandomAccessIterator from, RandomAccessIterator to,
+                             std::integral_constant<RadixOrder, Ascending>, std::vector<T, Alloc> &aux)
+        {
+            SortBy::radixSort(from, to, [](const T &val){ return SortBy::radixBits(val); }, aux);
+        }
+
+        template <class RandomAccessIterator, class T, class Alloc>
+        void radixSortValues(RandomAccessIterator from, RandomAccessIterator to,
+                             std::integral_constant<RadixOrder, Descending>, std::vector<T, Alloc> &aux)
+        {
+            typedef typename SortBy::RadixTraits<T>::Bits Bits;
+            SortBy::radixSort(from, to, [](const T &val){ return static_cast<Bits>( ~SortBy::radixBits(val)); }, aux);
+        }
+
+        /** Radix sort of arithmetic values in the given order */
+        template <class RandomAccessIterator, RadixOrder order>
+        void radixSortValues(RandomAccessIterator from, RandomAccessIterator to,
+                             std::integral_constant<RadixOrder, order> radix_order)
+        {
+            std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> aux;
+            radixSortValues(from, to, radix_order, aux);
+        }
+
+        /** Sort of the general case: radix sort if the values and the comparison allow it, merge sort otherwise */
+        template <class RandomAccessIterator, class Compare, class T, class Alloc, RadixOrder order>
+        void sortLarge(RandomAccessIterator from, RandomAccessIterator to, Compare &comp, bool use_radix,
+                       std::integral_constant<RadixOrder, order> radix_order, std::vector<T, Alloc> &aux)
+        {
+            if ( use_radix)
+            {
+                radixSortValues(from, to, radix_order, aux);
+            } else
+            {
+                mergeSortRecImpl(Scratch::fit(aux, std::distance(from, to)), from, to, comp);
+            }
+        }
+
+        template <class RandomAccessIterator, class Compare, class T, class Alloc>
+        void sortLarge(RandomAccessIterator from, RandomAccessIterator to, Compare &comp, bool use_radix,
+                       std::integral_constant<RadixOrder, NoRadix>, std::vector<T, Alloc> &aux)
+        {
+            mergeSortRecImpl(Scratch::fit(aux, std::distance(from, to)), from, to, comp);
+        }
+
+        /** Sort of the sequences longer than the insertion sort limit, see Alg::sort */
+        template <class RandomAccessIterator, class Compare, class BoundsAlloc, class Alloc>
+        void sortLong(RandomAccessIterator from, RandomAccessIterator to, SortStability stability, Compare &comp,
+                      std::vector<RandomAccessIterator, BoundsAlloc> &bounds,
+                      std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type, Alloc> &buf)
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+            const SortThresholds &thresholds = sortThresholds();
+
+            size_t size = std::distance(from, to);
+            const RadixOrder radix_order = RadixOrderOf<T, Compare>::value;
+            bool use_radix = (radix_order != NoRadix && size >= thresholds.radix_min);
+
+            // Radix sort gives NaN a fixed rank, a stable sort must keep it in place among the equivalent values
+            if ( use_radix && stability == Stable && hasNaN(from, to, typename std::is_floating_point<T>::type()))
+            {
+                use_radix = false;
+            }
+
+            // Presortedness probe: the number of monotone runs up to the natural merge limit.
+            // Natural merging beats merge sort on any input with few runs, but radix sort only on a handful of them
+            size_t runs_limit = size / thresholds.runs_ratio;
+            if ( use_radix) runs_limit = std::min(runs_limit, thresholds.radix_runs_max + 1);
+
+            if ( countRuns(from, to, runs_limit, comp) < runs_limit)
+            {
+                naturalMergeSort(from, to, stability, comp, bounds, buf);
+                return;
+            }
+
+            sortLarge(from, to, comp, use_radix, std::integral_constant<RadixOrder, radix_order>(), buf);
+        }
+
+        /** Sort of N elements: a sorting network for small sizes when stability is not required */
+        template <SortStability stability, size_t N, class RandomAccessIterator, class Compare>
+        void sortFixed(RandomAccessIterator from, Compare &comp, std::true_type use_network)
+        {
+            staticSort<N>(from, comp);
+        }
+
+        template <SortStability stability, size_t N, class RandomAccessIterator, class Compare>
+        void sortFixed(RandomAccessIterator from, Compare &comp, std::false_type use_network);
+    } /* namespace SortDispatch */
+
+    /**
+     * Sort elements between iterators picking the engine for the input:
+     *  - short sequences are sorted by insertion sort;
+     *  - sorted input is detected and left as is, input with few ascending/descending runs is merged naturally;
+     *  - integral and floating point values compared by std::less/std::greater are radix sorted;
+     *  - the rest is merge sorted.
+     * All engines are stable, 'NotStable' only allows reversing descending runs with equal elements.
+     * Call it qualified as Alg::sort to avoid clashing with std::sort found by ADL
+     * @ingroup Algorithms
+     */
+    template <SortStability stability = NotStable, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void sort(RandomAccessIterator from, RandomAccessIterator to, Compare comp = Compare())
+    {
+        size_t size = std::distance(from, to);
+        if (size < 2) return;
+
+        if (size <= sortThresholds().insertion_max)
+        {
+            Merge::insertionSortRun(from, to, comp);
+            return;
+        }
+
+        std::vector<RandomAccessIterator> bounds;
+        std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type> buf;
+        SortDispatch::sortLong(from, to, stability, comp, bounds, buf);
+    }
+
+    /**
+     * Sort elements between iterators picking the engine for the input (see above), the scratch memory
+     * is taken from the workspace. Reusing a workspace for many sorts avoids allocating on every call
+     * @ingroup Algorithms
+     */
+    template <SortStability stability = NotStable, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void sort(RandomAccessIterator from, RandomAccessIterator to, Workspace &ws, Compare comp = Compare())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+
+        size_t size = std::distance(from, to);
+        if (size < 2) return;
+
+        if (size <= sortThresholds().insertion_max)
+        {
+            Merge::insertionSortRun(from, to, comp);
+            return;
+        }
+
+        SortDispatch::sortLong(from, to, stability, comp, ws.buffer<RandomAccessIterator>(0), ws.buffer<T>(0));
+    }
+
+    /**
+     * Sort an array of size known at compile time. Arrays of up to StaticSort::max_size elements
+     * are sorted by a sorting network (see staticSort) unless a stable sort is requested
+     * @ingroup Algorithms
+     */
+    template <SortStability stability = NotStable, class T, size_t N, class Compare = std::less<T> >
+    void sort(std::array<T, N> &arr, Compare comp = Compare())
+    {
+        SortDispatch::sortFixed<stability, N>(arr.begin(), comp,
+            std::integral_constant<bool, stability == NotStable && N <= StaticSort::max_size>());
+    }
+
+    /**
+     * Sort a built-in array, see above
+     * @ingroup Algorithms
+     */
+    template <SortStability stability = NotStable, class T, size_t N, class Compare = std::less<T> >
+    typename SortDispatch::EnableIfComparison<Compare, T>::type
+    sort(T (&arr)[N], Compare comp = Compare())
+    {
+        SortDispatch::sortFixed<stability, N>(&arr[0], comp,
+            std::integral_constant<bool, stability == NotStable && N <= StaticSort::max_size>());
+    }
+
+    template <SortStability stability, size_t N, class RandomAccessIterator, class Compare>
+    void SortDispatch::sortFixed(RandomAccessIterator from, Compare &comp, std::false_type use_network)
+    {
+        Alg::sort<stability>(from, from + N, comp);
+    }
+
+    /**
+     * Sort elements between iterators under the execution policy. The parallel policies sort chunks
+     * with Alg::sort on the shared ThreadPool and merge them in parallel; stable merging keeps
+     * the Stable guarantee
+     * @ingroup Algorithms
+     */
+    template <SortStability stability = NotStable, class ExecutionPolicy, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    sort(const ExecutionPolicy &policy, RandomAccessIterator from, RandomAccessIterator to, Compare comp = Compare())
+    {
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value)
+        {
+            Alg::sort<stability>(from, to, comp);
+            return;
+        }
+        Parallel::sortMerge(from, to, comp, [comp](RandomAccessIterator first, RandomAccessIterator last)
+        {
+            Alg::sort<stability>(first, last, comp);
+        });
+    }
+
+    bool uTestSortDispatch(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -30,7 +30,7 @@ namespace Alg
             {
                 if (comp(*next, *cur))
                 {
-                    std::swap(*next, *cur);
+                    std::iter_swap(next, cur);
                     swapped = true;
                 }
             }
@@ -55,7 +55,7 @@ namespace Alg
                     min = cur;
                 }
             }
-            std::swap(*insert, *min);
+            std::iter_swap(insert, min);
         }
     }
 
@@ -72,7 +72,7 @@ namespace Alg
             {
                 auto prev = cur - 1;
                 if (comp(*cur, *prev))
-                    std::swap(*prev, *cur);
+                    std::iter_swap(prev, cur);
             }
         }
     }
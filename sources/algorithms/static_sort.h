@@ -0,0 +1,199 @@
+/**
+* @file: static_sort.h
+* Interface and implementation of sorting networks for sizes known at compile time
+* @ingroup Algorithms
+* @brief Compile-time generated sorting networks with branchless compare-exchange
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <array>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace Alg
+{
+    /*
+     * Sorting networks generated by templates. The network is Batcher's merge exchange (Knuth, TAOCP vol. 3,
+     * algorithm 5.2.2M) for any number of elements: it has the optimal number of comparators up to 8 elements
+     * and a few more than the best known networks above that (63 instead of 60 for 16 elements).
+     * Every comparator is a compare-exchange of two fixed positions, so the whole network is straight-line code
+     */
+    namespace StaticSort
+    {
+        /** Sizes up to this one are sorted by networks when the size is a compile-time constant */
+        const size_t max_size = 32;
+
+        /**
+         * Compare-exchange: after it a is not greater than b. Trivially copyable values are selected without
+         * branches (the compiler emits conditional moves or min/max), the others are swapped by moves
+         */
+        template <class T, class Compare>
+        ALG_CONSTEXPR14 void condSwap(T &a, T &b, Compare &comp, std::true_type branchless)
+        {
+            bool greater = comp(b, a);
+            T lo = greater ? b : a;
+            T hi = greater ? a : b;
+            a = lo;
+            b = hi;
+        }
+
+        template <class T, class Compare>
+        ALG_CONSTEXPR14 void condSwap(T &a, T &b, Compare &comp, std::false_type branchless)
+        {
+            if ( comp(b, a))
+            {
+                T tmp( std::move(a));
+                a = std::move(b);
+                b = std::move(tmp);
+            }
+        }
+
+        /** Element access of a std::array, usable in constant expressions */
+        template <class T, size_t N> struct ArrayAccess
+        {
+            typedef T value_type;
+            std::array<T, N> &arr;
+
+            template <size_t I> ALG_CONSTEXPR14 T &at() const { return std::get<I>(arr); }
+        };
+
+        /** Element access through a random access iterator */
+        template <class RandomAccessIterator> struct IteratorAccess
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+            RandomAccessIterator from;
+
+            template <size_t I> typename std::iterator_traits<RandomAccessIterator>::reference at() const
+            {
+                return from[I];
+            }
+        };
+
+        /** Comparator of positions I and J, present only if 'enabled' */
+        template <size_t I, size_t J, bool enabled> struct Comparator
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                typedef typename Access::value_type T;
+                condSwap(acc.template at<I>(), acc.template at<J>(), comp,
+                         std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+            }
+        };
+
+        template <size_t I, size_t J> struct Comparator<I, J, false>
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &, Compare &){}
+        };
+
+        /** Comparators (i, i + D) for i in [I, N - D) such that (i & P) == R */
+        template <size_t N, size_t I, size_t D, size_t P, size_t R, bool done = (I + D >= N)> struct Step
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                Comparator<I, I + D, (I & P) == R>::apply(acc, comp);
+                Step<N, I + 1, D, P, R>::apply(acc, comp);
+            }
+        };
+
+        template <size_t N, size_t I, size_t D, size_t P, size_t R> struct Step<N, I, D, P, R, true>
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &, Compare &){}
+        };
+
+        /** Merge rounds of one pass: q goes down from T to P, then the pass is over */
+        template <size_t N, size_t P, size_t Q, size_t R, size_t D, bool last = (Q == P)> struct Round
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                Step<N, 0, D, P, R>::apply(acc, comp);
+                Round<N, P, Q / 2, P, Q - P>::apply(acc, comp);
+            }
+        };
+
+        template <size_t N, size_t P, size_t Q, size_t R, size_t D> struct Round<N, P, Q, R, D, true>
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                Step<N, 0, D, P, R>::apply(acc, comp);
+            }
+        };
+
+        /** Passes of the merge exchange for p = T, T/2, ..., 1 */
+        template <size_t N, size_t P, size_t T> struct Pass
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                Round<N, P, T, 0, P>::apply(acc, comp);
+                Pass<N, P / 2, T>::apply(acc, comp);
+            }
+        };
+
+        template <size_t N, size_t T> struct Pass<N, 0, T>
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &, Compare &){}
+        };
+
+        /** Biggest power of two less than N (2^(t-1) for t = ceil(log2 N)), 0 for N < 2 */
+        template <size_t N, size_t P = 1, bool done = (2 * P >= N)> struct TopBit
+        {
+            static const size_t value = TopBit<N, 2 * P>::value;
+        };
+
+        template <size_t N, size_t P> struct TopBit<N, P, true>
+        {
+            static const size_t value = N < 2 ? 0 : P;
+        };
+
+        /** The whole network of N elements */
+        template <size_t N> struct Network
+        {
+            template <class Access, class Compare>
+            static ALG_CONSTEXPR14 void apply(const Access &acc, Compare &comp)
+            {
+                Pass<N, TopBit<N>::value, TopBit<N>::value>::apply(acc, comp);
+            }
+        };
+    } /* namespace StaticSort */
+
+    /**
+     * Sort an array of size known at compile time by a sorting network. The network is straight-line code
+     * of branchless compare-exchanges; the sort is not stable. Can be evaluated at compile time
+     * (with C++14 and a constexpr comparison such as std::less)
+     * @ingroup Algorithms
+     */
+    template <size_t N, class T, class Compare = std::less<T> >
+    ALG_CONSTEXPR14 void staticSort(std::array<T, N> &arr, Compare comp = Compare())
+    {
+        StaticSort::ArrayAccess<T, N> acc = { arr };
+        StaticSort::Network<N>::apply(acc, comp);
+    }
+
+    /**
+     * Sort N elements starting at 'from' by a sorting network, see above
+     * @ingroup Algorithms
+     */
+    template <size_t N, class RandomAccessIterator,
+              class Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void staticSort(RandomAccessIterator from, Compare comp = Compare())
+    {
+        StaticSort::IteratorAccess<RandomAccessIterator> acc = { from };
+        StaticSort::Network<N>::apply(acc, comp);
+    }
+
+    bool uTestStaticSort(UnitTest *utest_p);
+
+} /* namespace Alg */
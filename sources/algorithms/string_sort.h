@@ -0,0 +1,380 @@
+/**
+* @file: string_sort.h
+* Interface and implementation of the string sorting algorithms
+* @ingroup Algorithms
+* @brief Multikey quicksort, MSD radix sort and LCP merge sort of strings
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#    include <stdlib.h>
+#endif
+
+namespace Alg
+{
+    /**
+     * Access to the characters of the strings being sorted. The default one takes data() and size() of the
+     * element, which covers std::string, std::string_view and std::vector<char>. Records of other types
+     * are sorted with an access class of the same form passed to the sort
+     * @ingroup Algorithms
+     */
+    template <class T> struct StringAccess
+    {
+        const char *data(const T &str) const { return str.data(); }
+        size_t size(const T &str) const { return str.size(); }
+    };
+
+    /** Null-terminated strings */
+    template <> struct StringAccess<const char *>
+    {
+        const char *data(const char *str) const { return str; }
+        size_t size(const char *str) const { return std::strlen(str); }
+    };
+
+    /** Pointer and length records */
+    template <> struct StringAccess< std::pair<const char *, size_t> >
+    {
+        const char *data(const std::pair<const char *, size_t> &str) const { return str.first; }
+        size_t size(const std::pair<const char *, size_t> &str) const { return str.second; }
+    };
+
+    /*
+     * Helper routines of the string sorts. The sorts work on an array of references to the characters
+     * of the elements, so no string is copied; the elements are moved once, by the permutation at the end.
+     * Characters are compared as unsigned, as std::string does
+     */
+    namespace StringSort
+    {
+        const size_t insertion_max = 16; // Ranges up to this size are sorted by insertion sort
+        const size_t radix_min = 256;    // Shorter ranges are merge sorted, a radix pass does not pay off on them
+
+        /** Characters of an element and the cache of the radix sort */
+        struct StringKey
+        {
+            const char *chars;
+            size_t size;
+            UInt64 cache;
+        };
+
+        typedef SortBy::KeyIndex<StringKey> Item;
+
+        template <class RandomAccessIterator, class Access>
+        void extractKeys(RandomAccessIterator from, RandomAccessIterator to, Access &access, std::vector<Item> &items)
+        {
+            items.clear();
+            items.reserve( std::distance(from, to));
+
+            size_t index = 0;
+            for (auto pos = from; pos != to; ++pos)
+            {
+                Item item = { { access.data(*pos), access.size(*pos), 0 }, index++ };
+                items.push_back(item);
+            }
+        }
+
+        /**
+         * Compare strings that share the first 'depth' characters: negative if a is less, zero if they are equal,
+         * positive if b is less. Writes the length of the common prefix to 'lcp'
+         */
+        inline int compareFrom(const StringKey &a, const StringKey &b, size_t depth, size_t *lcp)
+        {
+            size_t size = std::min(a.size, b.size);
+            size_t i = depth;
+            while (i < size && a.chars[i] == b.chars[i]) i++;
+
+            *lcp = i;
+            if ( i < size) return static_cast<unsigned char>( a.chars[i]) < static_cast<unsigned char>( b.chars[i]) ? -1 : 1;
+            return a.size < b.size ? -1 : (a.size > b.size ? 1 : 0);
+        }
+
+        /** Stable insertion sort of the strings that share the first 'depth' characters */
+        inline void insertionSort(Item *from, Item *to, size_t depth)
+        {
+            if ( to - from < 2) return;
+
+            for (Item *pos = from + 1; pos < to; ++pos)
+            {
+                Item val = *pos;
+                Item *cur = pos;
+                size_t lcp;
+                for (; cur != from && compareFrom(val.key, (cur - 1)->key, depth, &lcp) < 0; --cur) *cur = *(cur - 1);
+                *cur = val;
+            }
+        }
+
+        /** Stable merge sort of the strings that share the first 'depth' characters, 'aux' is the scratch array */
+        inline void mergeSort(Item *from, Item *to, size_t depth, std::vector<Item> &aux)
+        {
+            auto less = [depth](const Item &a, const Item &b) { size_t lcp; return compareFrom(a.key, b.key, depth, &lcp) < 0; };
+
+            size_t size = to - from;
+            Merge::sortBuffered(from, to, Scratch::fit(aux, size).begin(), size, less);
+        }
+
+        /** First 8 characters of the string from the given position, big-endian, padded with zeros */
+        inline UInt64 loadBytes(const char *chars, size_t size)
+        {
+            if ( size >= 8)
+            {
+                UInt64 bytes;
+                std::memcpy(&bytes, chars, sizeof(bytes));
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                return __builtin_bswap64(bytes);
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                return bytes;
+#elif defined(_MSC_VER)
+                return _byteswap_uint64(bytes);
+#endif
+            }
+            UInt64 bytes = 0;
+            for (size_t k = 0; k < 8; k++) bytes = (bytes << 8) | (k < size ? static_cast<unsigned char>( chars[k]) : 0);
+            return bytes;
+        }
+
+        /** Cache the 8 characters of each string that follow the depth */
+        inline void loadCaches(Item *from, Item *to, size_t depth)
+        {
+            for (Item *pos = from; pos != to; ++pos)
+            {
+                StringKey &str = pos->key;
+                size_t skip = std::min(depth, str.size);
+                str.cache = loadBytes(str.chars + skip, str.size - skip);
+            }
+        }
+
+        /**
+         * Multikey quicksort (Bentley and Sedgewick) of the strings that share the first 'depth' characters,
+         * the caches hold the next 8 characters. The range is split three ways by the cached characters; the
+         * equal part goes on with the next 8 characters, so each string is read once per 8 characters of its
+         * distinguishing prefix rather than once per comparison. The strings of the equal part that end within
+         * the cached characters differ only by the length and come first
+         */
+        inline void multikeyQuickSort(Item *from, Item *to, size_t depth)
+        {
+            while (to - from > static_cast<ptrdiff_t>(insertion_max))
+            {
+                UInt64 a = from->key.cache;
+                UInt64 b = from[(to - from) / 2].key.cache;
+                UInt64 c = (to - 1)->key.cache;
+                UInt64 pivot = std::max( std::min(a, b), std::min( std::max(a, b), c));
+
+                // [from, lt) is less than the pivot, [lt, i) is equal, [gt, to) is greater
+                Item *lt = from, *i = from, *gt = to;
+                while (i < gt)
+                {
+                    UInt64 cache = i->key.cache;
+                    if ( cache < pivot) std::swap(*lt++, *i++);
+                    else if ( cache > pivot) std::swap(*i, *--gt);
+                    else i++;
+                }
+
+                multikeyQuickSort(from, lt, depth);
+                multikeyQuickSort(gt, to, depth);
+
+                size_t next_depth = depth + 8;
+                Item *longer = std::partition(lt, gt, [next_depth](const Item &item) { return item.key.size <= next_depth; });
+                std::sort(lt, longer, [](const Item &x, const Item &y) { return x.key.size < y.key.size; });
+
+                from = longer;
+                to = gt;
+                depth = next_depth;
+                loadCaches(from, to, depth);
+            }
+            insertionSort(from, to, depth);
+        }
+
+        /**
+         * MSD radix sort of the strings that share the first 'depth' characters. The next 8 characters of each
+         * string are cached in one integer and the range is sorted by the caches with the LSD radix sort, which
+         * skips the bytes that are the same in all the strings. In a group of equal caches the strings that
+         * end within the cached characters differ only by the length and come first; the rest go on at depth + 8.
+         * Ranges and groups shorter than radix_min are sorted by comparisons. The biggest of the groups that go on
+         * is sorted by the loop, the others are at most half of the range, so the recursion depth is logarithmic
+         * whatever the length of the common prefixes. The sort is stable
+         */
+        inline void radixSort(Item *from, Item *to, size_t depth, std::vector<Item> &aux)
+        {
+            while (true)
+            {
+                if ( to - from <= static_cast<ptrdiff_t>(insertion_max))
+                {
+                    insertionSort(from, to, depth);
+                    return;
+                }
+                if ( to - from < static_cast<ptrdiff_t>(radix_min))
+                {
+                    mergeSort(from, to, depth, aux);
+                    return;
+                }
+
+                loadCaches(from, to, depth);
+                SortBy::radixSort(from, to, [](const Item &item) { return item.key.cache; }, aux);
+
+                size_t next_depth = depth + 8;
+                auto clamped_size = [next_depth](const Item &item) { return std::min(item.key.size, next_depth + 1); };
+                Item *next_from = nullptr, *next_to = nullptr; // Biggest group to go on with
+
+                for (Item *group = from; group != to; )
+                {
+                    Item *end = group + 1;
+                    while (end != to && end->key.cache == group->key.cache) ++end;
+
+                    if ( end - group < static_cast<ptrdiff_t>(radix_min))
+                    {
+                        // The strings of the group share the cached characters, the comparisons start after them
+                        if ( end - group > 1) mergeSort(group, end, next_depth, aux);
+                    } else
+                    {
+                        // Order by length only if some strings end within the cached characters
+                        bool has_short = std::any_of(group, end, [next_depth](const Item &item) { return item.key.size <= next_depth; });
+                        if ( has_short) SortBy::radixSort(group, end, clamped_size, aux);
+
+                        Item *longer = group;
+                        while (longer != end && longer->key.size <= next_depth) ++longer;
+                        if ( end - longer > next_to - next_from)
+                        {
+                            if ( next_from) radixSort(next_from, next_to, next_depth, aux);
+                            next_from = longer;
+                            next_to = end;
+                        } else
+                        {
+                            radixSort(longer, end, next_depth, aux);
+                        }
+                    }
+                    group = end;
+                }
+                if ( !next_from) return;
+
+                from = next_from;
+                to = next_to;
+                depth = next_depth;
+            }
+        }
+
+        /**
+         * Merge of two sorted runs with their LCP arrays (lcp[i] is the common prefix of elements i - 1 and i).
+         * The common prefixes of the current elements of the runs with the last output element tell which of
+         * them is smaller unless they are equal, and then the comparison starts after the common prefix
+         */
+        inline void lcpMerge(const Item *a, const size_t *lcp_a, size_t size_a,
+                             const Item *b, const size_t *lcp_b, size_t size_b, Item *out, size_t *lcp_out)
+        {
+            size_t i = 0, j = 0, k = 0;
+            size_t ha = 0, hb = 0; // Common prefixes of a[i] and b[j] with the last output element
+
+            while (i < size_a && j < size_b)
+            {
+                size_t lcp;
+                if ( ha > hb || (ha == hb && compareFrom(a[i].key, b[j].key, ha, &lcp) <= 0))
+                {
+                    if ( ha == hb) hb = lcp;
+                    out[k] = a[i];
+                    lcp_out[k++] = ha;
+                    if ( ++i < size_a) ha = lcp_a[i];
+                } else
+                {
+                    if ( ha == hb) ha = lcp;
+                    out[k] = b[j];
+                    lcp_out[k++] = hb;
+                    if ( ++j < size_b) hb = lcp_b[j];
+                }
+            }
+            for (; i < size_a; i++, k++)
+            {
+                out[k] = a[i];
+                lcp_out[k] = ha;
+                if ( i + 1 < size_a) ha = lcp_a[i + 1];
+            }
+            for (; j < size_b; j++, k++)
+            {
+                out[k] = b[j];
+                lcp_out[k] = hb;
+                if ( j + 1 < size_b) hb = lcp_b[j + 1];
+            }
+        }
+
+        /** LCP merge sort of 'size' items, 'tmp' and 'tmp_lcp' are the scratch arrays of the same size */
+        inline void lcpMergeSort(Item *items, size_t *lcp, size_t size, Item *tmp, size_t *tmp_lcp)
+        {
+            if ( size <= insertion_max)
+            {
+                insertionSort(items, items + size, 0);
+                if ( size > 0) lcp[0] = 0;
+                for (size_t i = 1; i < size; i++) compareFrom(items[i - 1].key, items[i].key, 0, &lcp[i]);
+                return;
+            }
+
+            size_t half = size / 2;
+            lcpMergeSort(items, lcp, half, tmp, tmp_lcp);
+            lcpMergeSort(items + half, lcp + half, size - half, tmp, tmp_lcp);
+
+            lcpMerge(items, lcp, half, items + half, lcp + half, size - half, tmp, tmp_lcp);
+            std::copy(tmp, tmp + size, items);
+            std::copy(tmp_lcp, tmp_lcp + size, lcp);
+        }
+    } /* namespace StringSort */
+
+    /**
+     * Sort strings by multikey quicksort on 8 cached characters. The sort is not stable
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Access = StringAccess<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void multikeyQuickSort(RandomAccessIterator from, RandomAccessIterator to, Access access = Access())
+    {
+        std::vector<StringSort::Item> items;
+        StringSort::extractKeys(from, to, access, items);
+        StringSort::loadCaches(items.data(), items.data() + items.size(), 0);
+        StringSort::multikeyQuickSort(items.data(), items.data() + items.size(), 0);
+        SortBy::applyPermutation(from, items);
+    }
+
+    /**
+     * Sort strings by MSD radix sort with 8 characters cached per pass. The sort is stable
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Access = StringAccess<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void stringRadixSort(RandomAccessIterator from, RandomAccessIterator to, Access access = Access())
+    {
+        std::vector<StringSort::Item> items, aux;
+        StringSort::extractKeys(from, to, access, items);
+        StringSort::radixSort(items.data(), items.data() + items.size(), 0, aux);
+        SortBy::applyPermutation(from, items);
+    }
+
+    /**
+     * Sort strings by LCP merge sort (Ng and Kakehi): merges compare only the characters after the common
+     * prefixes known from the LCP arrays of the runs. lcp[i] receives the length of the common prefix of the
+     * sorted strings i - 1 and i, lcp[0] is 0. The sort is stable
+     * @ingroup Algorithms
+     */
+    template <class RandomAccessIterator,
+              class Access = StringAccess<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+    void lcpMergeSort(RandomAccessIterator from, RandomAccessIterator to, std::vector<size_t> &lcp,
+                      Access access = Access())
+    {
+        std::vector<StringSort::Item> items;
+        StringSort::extractKeys(from, to, access, items);
+
+        size_t size = items.size();
+        std::vector<StringSort::Item> tmp(size);
+        std::vector<size_t> tmp_lcp(size);
+        lcp.resize(size);
+        StringSort::lcpMergeSort(items.data(), lcp.data(), size, tmp.data(), tmp_lcp.data());
+        SortBy::applyPermutation(from, items);
+    }
+
+    bool uTestStringSort(UnitTest *utest_p);
+
+} /* namespace Alg */
@@ -39,5 +39,11 @@ namespace Alg
     {
         return data[i] == data[j];
     }
+
+    /** Component id of the node, it is one of the component's nodes */
+    UInt32 PlainUF::find(UInt32 i) const
+    {
+        return data[i];
+    }
     
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 * Copyright (C) 2015  Boris Shurygin
 */
 #include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace Alg
 {
@@ -21,8 +23,11 @@ namespace Alg
     {
     public:
         UF(UInt32 size) : UFImplementation(size){};   /**< Constructs UF data structure of given size */
+        UF(UInt32 size, const StorageOptions &storage) /**< Same with the storage of the big arrays    */
+            : UFImplementation(size, storage){};
         inline void unite(UInt32 i, UInt32 j);        /**< Connect the given nodes                    */
         inline bool areConnected(UInt32 i, UInt32 j); /**< Check if the given nodes are connected     */
+        inline UInt32 find(UInt32 i) const;           /**< Representative of the node's component     */
     };
 
     template < class UFImplementation> 
@@ -37,6 +42,12 @@ namespace Alg
         return UFImplementation::areConnected(i, j);
     }
 
+    template < class UFImplementation>
+    UInt32 UF<UFImplementation>::find(UInt32 i) const
+    {
+        return UFImplementation::find(i);
+    }
+
     /** Naive implementation of union-find with plain array of component ids */
     class PlainUF
     {
@@ -44,6 +55,7 @@ namespace Alg
         PlainUF(UInt32 size);
         void unite(UInt32 i, UInt32 j);        /**< Connect the given nodes */
         bool areConnected(UInt32 i, UInt32 j); /**< Check if the given nodes are connected */
+        UInt32 find(UInt32 i) const;           /**< Representative of the node's component */
     private:
         std::vector<UInt32> data;
     };
@@ -52,18 +64,21 @@ namespace Alg
     enum TreeUFWeighted { NotWeighted, Weighted };
     enum TreeUFCompress { NoCompression, PathCompression};
 
+    /** Per-node arrays of TreeUF, they can be big enough for huge pages and NUMA placement */
+    typedef std::vector<UInt32, LargeAllocator<UInt32> > UFArray;
+
     template <TreeUFWeighted Weighted> struct WeightsImpl;
     template <> struct WeightsImpl< NotWeighted > // Empty implementation
     {
-        WeightsImpl(UInt32 size){}
+        WeightsImpl(UInt32 size, const StorageOptions &storage){}
         inline void include(UInt32 parent, UInt32 child){}; /**< Update the weights */
         /** Select parent and child items */
         inline void selectParent(UInt32 i, UInt32 j, UInt32 *parent, UInt32 *child) {};
     };
     template <> struct WeightsImpl< Weighted >
     {
-        std::vector<UInt32> sizes;
-        WeightsImpl(UInt32 size):sizes(size, 1){}
+        UFArray sizes;
+        WeightsImpl(UInt32 size, const StorageOptions &storage):sizes(size, 1, LargeAllocator<UInt32>(storage)){}
         
         /** Update the weights */
         inline void include(UInt32 parent, UInt32 child)
@@ -87,11 +102,11 @@ namespace Alg
     template <TreeUFCompress compress> struct PathCompImpl;
     template <> struct PathCompImpl < NoCompression > 
     {
-        static inline void pathCompression(std::vector<UInt32> &root, UInt32 i) {};
+        static inline void pathCompression(UFArray &root, UInt32 i) {};
     };
     template <> struct PathCompImpl < PathCompression >
     {
-        static inline void pathCompression(std::vector<UInt32> &root, UInt32 i) 
+        static inline void pathCompression(UFArray &root, UInt32 i) 
         {
             root[i] = root[root[i]];
         };
@@ -99,26 +114,28 @@ namespace Alg
 
 
     /** 
-     * Tree based implementation of union-find
+     * Tree based implementation of union-find. The storage options place the per-node arrays on huge
+     * pages and across NUMA nodes, see LargeAllocator
      * @ingroup Algorithms
      */
     template <TreeUFWeighted is_weighted = Weighted,
               TreeUFCompress compress = PathCompression> class TreeUF
     {
     public:
-        TreeUF(UInt32 size);
+        TreeUF(UInt32 size, const StorageOptions &storage = StorageOptions());
         void unite(UInt32 i, UInt32 j);        /**< Connect the given nodes */
         bool areConnected(UInt32 i, UInt32 j); /**< Check if the given nodes are connected */
+        UInt32 find(UInt32 i) const;           /**< Root of the node's tree, does not compress the path */
     private:
         UInt32 findRoot(UInt32 i);
-        std::vector<UInt32> root;
+        UFArray root;
         WeightsImpl < is_weighted > weights;
     };
     
     /* Constructor implementation */
     template <TreeUFWeighted is_weighted, TreeUFCompress compress>
-    TreeUF<is_weighted, compress>::TreeUF(UInt32 size):
-        root(size), weights(size)
+    TreeUF<is_weighted, compress>::TreeUF(UInt32 size, const StorageOptions &storage):
+        root(size, 0, LargeAllocator<UInt32>(storage)), weights(size, storage)
     {
         UInt32 i = 0;
         for (UInt32 &elem : root)
@@ -146,6 +163,14 @@ namespace Alg
         return i;
     }
 
+    /* Read-only root lookup, safe to run from several threads at once */
+    template <TreeUFWeighted is_weighted, TreeUFCompress compress>
+    UInt32 TreeUF<is_weighted, compress>::find(UInt32 i) const
+    {
+        while (root[i] != i) i = root[i];
+        return i;
+    }
+
     /* Unite rotine depends on weighted-non weighted option */
     template <TreeUFWeighted is_weighted, TreeUFCompress compress>
     void TreeUF<is_weighted, compress>::unite(UInt32 i, UInt32 j)
@@ -161,6 +186,89 @@ namespace Alg
         weights.include(root_i, root_j);
     }
 
+    /** Pairs of nodes for the batch operations */
+    typedef std::vector< std::pair<UInt32, UInt32> > UFPairs;
+
+    /**
+     * Connect the nodes of all the pairs, in order
+     * @ingroup Algorithms
+     */
+    template <class UFType>
+    void uniteBatch(UFType &uf, const UFPairs &pairs)
+    {
+        for (const std::pair<UInt32, UInt32> &pair : pairs) uf.unite(pair.first, pair.second);
+    }
+
+    /**
+     * Connect the nodes of all the pairs under the execution policy. The structure is not concurrent,
+     * so the parallel policies only look up the representatives of all the nodes on the shared ThreadPool;
+     * the representatives are then united in order, which connects the same components
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class UFType>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    uniteBatch(const ExecutionPolicy &policy, UFType &uf, const UFPairs &pairs)
+    {
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value || pairs.size() < 2 * Parallel::search_block)
+        {
+            uniteBatch(uf, pairs);
+            return;
+        }
+
+        UFPairs roots(pairs.size());
+        ThreadPool::instance().parallelFor( (pairs.size() + Parallel::search_block - 1) / Parallel::search_block,
+                                            [&](size_t block)
+        {
+            size_t last = std::min(pairs.size(), (block + 1) * Parallel::search_block);
+            for (size_t i = block * Parallel::search_block; i < last; i++)
+            {
+                roots[i] = std::make_pair( uf.find(pairs[i].first), uf.find(pairs[i].second));
+            }
+        });
+        uniteBatch(uf, roots);
+    }
+
+    /**
+     * Check the pairs for connection, results[i] is 1 if the nodes of pairs[i] are connected
+     * @ingroup Algorithms
+     */
+    template <class UFType>
+    void areConnectedBatch(UFType &uf, const UFPairs &pairs, std::vector<UInt8> &results)
+    {
+        results.resize( pairs.size());
+        for (size_t i = 0; i < pairs.size(); i++)
+        {
+            results[i] = uf.areConnected(pairs[i].first, pairs[i].second) ? 1 : 0;
+        }
+    }
+
+    /**
+     * Check the pairs for connection under the execution policy. The parallel policies use the read-only
+     * find() on the shared ThreadPool, so paths are not compressed
+     * @ingroup Algorithms
+     */
+    template <class ExecutionPolicy, class UFType>
+    typename execution::EnableIfPolicy<ExecutionPolicy>::type
+    areConnectedBatch(const ExecutionPolicy &policy, UFType &uf, const UFPairs &pairs, std::vector<UInt8> &results)
+    {
+        if ( !execution::IsParallelPolicy<ExecutionPolicy>::value || pairs.size() < 2 * Parallel::search_block)
+        {
+            areConnectedBatch(uf, pairs, results);
+            return;
+        }
+
+        results.resize( pairs.size());
+        ThreadPool::instance().parallelFor( (pairs.size() + Parallel::search_block - 1) / Parallel::search_block,
+                                            [&](size_t block)
+        {
+            size_t last = std::min(pairs.size(), (block + 1) * Parallel::search_block);
+            for (size_t i = block * Parallel::search_block; i < last; i++)
+            {
+                results[i] = uf.find(pairs[i].first) == uf.find(pairs[i].second) ? 1 : 0;
+            }
+        });
+    }
+
     // Test template for all implementations of uf
     template <class UFImpl> bool uTestUF(UnitTest *utest_p)
     {
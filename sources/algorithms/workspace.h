@@ -0,0 +1,251 @@
+/**
+* @file: workspace.h
+* Interface and implementation of the memory helpers of algorithms
+* @ingroup Algorithms
+* @brief Reusable scratch workspace for algorithms, monotonic arena and its standard allocator
+*/
+/*
+* Algorithms library
+* Copyright (C) 2015  Boris Shurygin
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <algorithm>
+
+namespace Alg
+{
+    /**
+     * Monotonic memory arena. Allocation bumps a pointer in the current block, a new block (twice the size of
+     * the previous one) is taken when the current one is exhausted. Memory is not freed one allocation at a time:
+     * release() frees everything at once and keeps the biggest block, so a loop that releases the arena after
+     * each iteration stops calling the system allocator once the block is big enough.
+     * Blocks are taken with ::operator new
+     * @ingroup Algorithms
+     */
+    class Arena
+    {
+    public:
+        explicit Arena(size_t block_size = 64 * 1024); /**< Arena with the given size of the first block */
+        ~Arena();
+
+        void *allocate(size_t size, size_t align);     /**< Allocate aligned memory                     */
+        void release();                                /**< Free all the allocations                    */
+
+        size_t bytesUsed() const;                      /**< Bytes allocated since the last release      */
+
+    private:
+        Arena(const Arena &);
+        Arena &operator=(const Arena &);
+
+        /** Header of a block, the memory follows it */
+        struct Block
+        {
+            Block *prev;
+            size_t size;
+        };
+
+        void addBlock(size_t min_size);
+
+        Block *last;       // Current block, the previous ones are linked from it
+        char *cur;         // Free memory of the current block
+        char *end;
+        size_t block_size; // Size of the next block
+        size_t used;
+    };
+
+    inline Arena::Arena(size_t size):
+        last(nullptr), cur(nullptr), end(nullptr), block_size(std::max<size_t>(size, 256)), used(0)
+    {
+
+    }
+
+    inline Arena::~Arena()
+    {
+        while (last)
+        {
+            Block *prev = last->prev;
+            ::operator delete(last);
+            last = prev;
+        }
+    }
+
+    inline void Arena::addBlock(size_t min_size)
+    {
+        size_t size = std::max(block_size, min_size + sizeof(Block));
+        Block *block = static_cast<Block *>( ::operator new(size));
+        block->prev = last;
+        block->size = size;
+
+        last = block;
+        cur = reinterpret_cast<char *>(block + 1);
+        end = reinterpret_cast<char *>(block) + size;
+        block_size = 2 * size;
+    }
+
+    inline void *Arena::allocate(size_t size, size_t align)
+    {
+        size_t pad = (align - reinterpret_cast<size_t>(cur) % align) % align;
+        if ( !cur || size + pad > static_cast<size_t>(end - cur) )
+        {
+            addBlock(size + align);
+            pad = (align - reinterpret_cast<size_t>(cur) % align) % align;
+        }
+
+        void *res = cur + pad;
+        cur += pad + size;
+        used += size;
+        return res;
+    }
+
+    inline void Arena::release()
+    {
+        if ( !last) return;
+
+        // The current block is the biggest one, it is kept
+        Block *prev = last->prev;
+        while (prev)
+        {
+            Block *next = prev->prev;
+            ::operator delete(prev);
+            prev = next;
+        }
+        last->prev = nullptr;
+        cur = reinterpret_cast<char *>(last + 1);
+        end = reinterpret_cast<char *>(last) + last->size;
+        used = 0;
+    }
+
+    inline size_t Arena::bytesUsed() const
+    {
+        return used;
+    }
+
+    /**
+     * Standard allocator on top of an Arena. Deallocation does nothing, the memory comes back on Arena::release().
+     * Can be used with the standard containers and with PriorityQueue
+     * @ingroup Algorithms
+     */
+    template <class T> class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template <class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+        explicit ArenaAllocator(Arena &a): arena(&a){}
+        template <class U> ArenaAllocator(const ArenaAllocator<U> &other): arena(other.arena){}
+
+        T *allocate(size_t n)
+        {
+            return static_cast<T *>( arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *ptr, size_t n) {}
+
+        template <class U> bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+        template <class U> bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+    private:
+        template <class U> friend class ArenaAllocator;
+
+        Arena *arena;
+    };
+
+    /**
+     * Reusable scratch memory of algorithms. Algorithms that take a Workspace get their temporary buffers
+     * from it instead of allocating them on every call; the buffers keep their capacity between the calls.
+     * The buffers are allocated by LargeAllocator with the storage options of the workspace, so the pages of a big
+     * buffer are mapped and placed (see StorageOptions) before its elements are written. A workspace must not
+     * be used by two threads at the same time
+     * @ingroup Algorithms
+     */
+    class Workspace
+    {
+    public:
+        Workspace(){}
+        explicit Workspace(const StorageOptions &opt): storage(opt){}
+
+        /**
+         * Buffer of the given type with at least 'size' elements. Contents are left from the previous use,
+         * a buffer that grows keeps them in its first elements.
+         * Algorithms that need two buffers of the same type use different slots
+         */
+        template <class T> std::vector<T, LargeAllocator<T> > &buffer(size_t size, unsigned slot = 0);
+
+        void release(); /**< Free the memory of all the buffers */
+
+    private:
+        Workspace(const Workspace &);
+        Workspace &operator=(const Workspace &);
+
+        static const unsigned num_slots = 2;
+
+        struct Slot
+        {
+            virtual ~Slot(){}
+        };
+        template <class T> struct TypedSlot: Slot
+        {
+            explicit TypedSlot(const StorageOptions &opt): data( LargeAllocator<T>(opt)){}
+
+            std::vector<T, LargeAllocator<T> > data;
+        };
+
+        /** Small dense id of the type, used as the index of its slots */
+        template <class T> static size_t typeId();
+        static size_t nextTypeId();
+
+        std::vector< std::unique_ptr<Slot> > slots;
+        StorageOptions storage;
+    };
+
+    inline size_t Workspace::nextTypeId()
+    {
+        static std::atomic<size_t> next_id(0);
+        return next_id++;
+    }
+
+    template <class T>
+    size_t Workspace::typeId()
+    {
+        static const size_t id = nextTypeId();
+        return id;
+    }
+
+    template <class T>
+    std::vector<T, LargeAllocator<T> > &Workspace::buffer(size_t size, unsigned slot)
+    {
+        UTILS_ASSERTD( slot < num_slots);
+
+        size_t index = typeId<T>() * num_slots + slot;
+        if ( index >= slots.size()) slots.resize(index + 1);
+        if ( !slots[index]) slots[index].reset( new TypedSlot<T>(storage));
+
+        std::vector<T, LargeAllocator<T> > &data = static_cast<TypedSlot<T> *>( slots[index].get())->data;
+        if ( data.size() < size) data.resize(size);
+        return data;
+    }
+
+    inline void Workspace::release()
+    {
+        slots.clear();
+    }
+
+    /* Helpers of the algorithms with scratch memory */
+    namespace Scratch
+    {
+        /** Make sure the buffer has at least 'size' elements */
+        template <class T, class Alloc>
+        std::vector<T, Alloc> &fit(std::vector<T, Alloc> &buf, size_t size)
+        {
+            if ( buf.size() < size) buf.resize(size);
+            return buf;
+        }
+    } /* namespace Scratch */
+
+    bool uTestWorkspace(UnitTest *utest_p);
+
+} /* namespace Alg */
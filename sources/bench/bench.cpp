@@ -0,0 +1,444 @@
+/**
+ * @file: bench/bench.cpp
+ * Implementation of the benchmark harness: input generation, timing, statistics, output and comparison
+ */
+/*
+ * Algorithms library
+ * Copyright (C) 2015  Boris Shurygin
+ */
+#include "bench.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <cmath>
+
+namespace Bench
+{
+    static const char *distribution_names[NumDistributions] =
+    {
+        "random", "sorted", "reversed", "few_unique", "organ_pipe"
+    };
+
+    const char *distributionName(Distribution dist)
+    {
+        return distribution_names[dist];
+    }
+
+    bool parseDistribution(const std::string &name, Distribution *dist)
+    {
+        for (int i = 0; i < NumDistributions; i++)
+        {
+            if ( name == distribution_names[i])
+            {
+                *dist = static_cast<Distribution>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Dataset::Dataset(Distribution d, size_t n, UInt64 seed, size_t num_queries):
+        dist(d), size(n), values(n)
+    {
+        // Every point gets its own stream so that adding sizes or distributions does not change the others
+        Alg::Xoshiro256 rng(seed ^ (static_cast<UInt64>(n) << 8) ^ d);
+
+        for (UInt32 &val : values)
+        {
+            val = static_cast<UInt32>( rng() >> 32);
+        }
+        switch (dist)
+        {
+        case Sorted:
+            std::sort(values.begin(), values.end());
+            break;
+        case Reversed:
+            std::sort(values.begin(), values.end(), std::greater<UInt32>());
+            break;
+        case FewUnique:
+            for (UInt32 &val : values) val = (val >> 28) * 0x10000001u;
+            break;
+        case OrganPipe:
+            std::sort(values.begin(), values.begin() + n / 2);
+            std::sort(values.begin() + n / 2, values.end(), std::greater<UInt32>());
+            break;
+        default:
+            break;
+        }
+
+        sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+
+        // Half of the queries hit the table, the other half are random values
+        queries.resize(n > 0 ? num_queries : 0);
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            queries[i] = (i % 2 == 0) ? sorted[rng.bounded(n)] : static_cast<UInt32>( rng() >> 32);
+        }
+    }
+
+    std::vector<Case> &cases()
+    {
+        static std::vector<Case> all_cases;
+        return all_cases;
+    }
+
+    Config::Config():
+        warmup(1), reps(10), num_queries(1 << 14), min_batch_work(1 << 16), seed(1)
+    {
+        for (int i = 0; i < NumDistributions; i++)
+        {
+            dists.push_back( static_cast<Distribution>(i));
+        }
+    }
+
+    /** Whether the case is selected by the suite and name filters */
+    static bool isSelected(const Case &c, const Config &config)
+    {
+        if ( !config.suites.empty()
+             && std::find(config.suites.begin(), config.suites.end(), c.suite) == config.suites.end() )
+        {
+            return false;
+        }
+        if ( config.filters.empty()) return true;
+
+        for (const std::string &filter : config.filters)
+        {
+            if ( c.name.find(filter) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    /** Value of the given percentile of the sorted samples (nearest rank) */
+    static double percentile(const std::vector<double> &sorted, double p)
+    {
+        size_t rank = static_cast<size_t>( std::ceil(p / 100 * sorted.size()));
+        return sorted[ std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    /** Time one (case, dataset) point */
+    static Result measure(const Case &c, const Dataset &data, const Config &config)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        Result res;
+        res.suite = c.suite;
+        res.name = c.name;
+        res.dist = distributionName(data.dist);
+        res.size = data.size;
+        res.reps = config.reps;
+        res.work = static_cast<double>( c.per_query ? config.num_queries : data.size);
+
+        // Small inputs run several times per sample to stay well above the clock resolution
+        res.batch = std::max<size_t>(1, config.min_batch_work / std::max<size_t>(1, static_cast<size_t>(res.work)));
+
+        Runner runner = c.prepare(data, res.batch);
+        for (unsigned i = 0; i < config.warmup; i++)
+        {
+            runner.reset();
+            runner.run();
+        }
+
+        std::vector<double> samples;
+        for (unsigned i = 0; i < config.reps; i++)
+        {
+            runner.reset();
+            Clock::time_point start = Clock::now();
+            runner.run();
+            Clock::time_point stop = Clock::now();
+            samples.push_back( std::chrono::duration<double, std::nano>(stop - start).count() / res.batch);
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double sample : samples) sum += sample;
+
+        res.min_ns = samples.front();
+        res.median_ns = percentile(samples, 50);
+        res.p90_ns = percentile(samples, 90);
+        res.p99_ns = percentile(samples, 99);
+        res.mean_ns = sum / samples.size();
+        return res;
+    }
+
+    std::vector<Result> run(const Config &config, std::ostream *progress)
+    {
+        std::vector<Result> results;
+        std::vector<const Case *> selected;
+        for (const Case &c : cases())
+        {
+            if ( isSelected(c, config)) selected.push_back(&c);
+        }
+
+        for (Distribution dist : config.dists)
+        {
+            // Sizes of all selected cases, each case runs at its own default sizes unless they are given
+            std::vector<size_t> sizes = config.sizes;
+            if ( sizes.empty())
+            {
+                for (const Case *c : selected) sizes.insert(sizes.end(), c->sizes.begin(), c->sizes.end());
+                std::sort(sizes.begin(), sizes.end());
+                sizes.erase( std::unique(sizes.begin(), sizes.end()), sizes.end());
+            }
+
+            for (size_t size : sizes)
+            {
+                Dataset data(dist, size, config.seed, config.num_queries);
+
+                for (const Case *c : selected)
+                {
+                    if ( size > c->max_size || size == 0) continue;
+                    if ( config.sizes.empty()
+                         && std::find(c->sizes.begin(), c->sizes.end(), size) == c->sizes.end() )
+                    {
+                        continue;
+                    }
+
+                    results.push_back( measure(*c, data, config));
+                    if ( progress)
+                    {
+                        writeTable(*progress, std::vector<Result>(1, results.back()));
+                        progress->flush();
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+    void writeJson(std::ostream &os, const std::vector<Result> &results, const Config &config)
+    {
+        os << "{\n";
+        os << "  \"config\": { \"reps\": " << config.reps << ", \"warmup\": " << config.warmup
+           << ", \"seed\": " << config.seed << ", \"num_queries\": " << config.num_queries << " },\n";
+        os << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &r = results[i];
+            os << std::setprecision(10)
+               << "    { \"suite\": \"" << r.suite << "\", \"name\": \"" << r.name << "\", \"dist\": \"" << r.dist
+               << "\", \"size\": " << r.size << ", \"reps\": " << r.reps << ", \"batch\": " << r.batch
+               << ", \"work\": " << r.work << ", \"min_ns\": " << r.min_ns << ", \"median_ns\": " << r.median_ns
+               << ", \"p90_ns\": " << r.p90_ns << ", \"p99_ns\": " << r.p99_ns << ", \"mean_ns\": " << r.mean_ns
+               << ", \"ns_per_op\": " << r.nsPerOp() << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "  ]\n}\n";
+    }
+
+    static const char *csv_header = "suite,name,dist,size,reps,batch,work,min_ns,median_ns,p90_ns,p99_ns,mean_ns,ns_per_op";
+
+    void writeCsv(std::ostream &os, const std::vector<Result> &results)
+    {
+        os << csv_header << "\n";
+        for (const Result &r : results)
+        {
+            os << std::setprecision(10)
+               << r.suite << "," << r.name << "," << r.dist << "," << r.size << "," << r.reps << "," << r.batch << ","
+               << r.work << "," << r.min_ns << "," << r.median_ns << "," << r.p90_ns << "," << r.p99_ns << ","
+               << r.mean_ns << "," << r.nsPerOp() << "\n";
+        }
+    }
+
+    void writeTable(std::ostream &os, const std::vector<Result> &results)
+    {
+        for (const Result &r : results)
+        {
+            std::ostringstream line;
+            line << std::left << std::setw(9) << r.suite << std::setw(28) << r.name << std::setw(11) << r.dist
+                 << std::right << std::setw(9) << r.size << std::fixed << std::setprecision(2)
+                 << std::setw(14) << r.median_ns / 1000 << " us"
+                 << std::setw(10) << r.nsPerOp() << " ns/op"
+                 << "  p90 " << r.p90_ns / 1000 << " us";
+            os << line.str() << "\n";
+        }
+    }
+
+    /** Set the result field by its name in the output */
+    static void setField(Result *r, const std::string &key, const std::string &val)
+    {
+        if ( key == "suite") r->suite = val;
+        else if ( key == "name") r->name = val;
+        else if ( key == "dist") r->dist = val;
+        else if ( key == "size") r->size = std::strtoull(val.c_str(), nullptr, 10);
+        else if ( key == "reps") r->reps = static_cast<unsigned>( std::strtoul(val.c_str(), nullptr, 10));
+        else if ( key == "batch") r->batch = std::strtoull(val.c_str(), nullptr, 10);
+        else if ( key == "work") r->work = std::strtod(val.c_str(), nullptr);
+        else if ( key == "min_ns") r->min_ns = std::strtod(val.c_str(), nullptr);
+        else if ( key == "median_ns") r->median_ns = std::strtod(val.c_str(), nullptr);
+        else if ( key == "p90_ns") r->p90_ns = std::strtod(val.c_str(), nullptr);
+        else if ( key == "p99_ns") r->p99_ns = std::strtod(val.c_str(), nullptr);
+        else if ( key == "mean_ns") r->mean_ns = std::strtod(val.c_str(), nullptr);
+    }
+
+    /** Read the flat result objects of the "results" array written by writeJson */
+    static void readJson(const std::string &text, std::vector<Result> *results)
+    {
+        size_t pos = text.find("\"results\"");
+        if ( pos == std::string::npos) return;
+
+        while ( (pos = text.find('{', pos)) != std::string::npos)
+        {
+            size_t end = text.find('}', pos);
+            if ( end == std::string::npos) break;
+
+            Result r = Result();
+            std::string object = text.substr(pos + 1, end - pos - 1);
+            std::istringstream fields(object);
+            std::string field;
+            while ( std::getline(fields, field, ','))
+            {
+                size_t colon = field.find(':');
+                if ( colon == std::string::npos) continue;
+
+                auto strip = [](std::string s)
+                {
+                    const char *blank = " \t\r\n\"";
+                    size_t first = s.find_first_not_of(blank);
+                    if ( first == std::string::npos) return std::string();
+                    return s.substr(first, s.find_last_not_of(blank) - first + 1);
+                };
+                setField(&r, strip(field.substr(0, colon)), strip(field.substr(colon + 1)));
+            }
+            results->push_back(r);
+            pos = end;
+        }
+    }
+
+    static void readCsv(std::istream &is, std::vector<Result> *results)
+    {
+        std::string line;
+        std::vector<std::string> keys;
+        while ( std::getline(is, line))
+        {
+            if ( !line.empty() && line.back() == '\r') line.pop_back();
+            if ( line.empty()) continue;
+
+            std::vector<std::string> cells;
+            std::istringstream row(line);
+            std::string cell;
+            while ( std::getline(row, cell, ',')) cells.push_back(cell);
+
+            if ( keys.empty())
+            {
+                keys = cells;
+                continue;
+            }
+            Result r = Result();
+            for (size_t i = 0; i < cells.size() && i < keys.size(); i++) setField(&r, keys[i], cells[i]);
+            results->push_back(r);
+        }
+    }
+
+    bool readResults(const std::string &file_name, std::vector<Result> *results)
+    {
+        std::ifstream file(file_name.c_str());
+        if ( !file) return false;
+
+        std::stringstream text;
+        text << file.rdbuf();
+        std::string str = text.str();
+
+        size_t first = str.find_first_not_of(" \t\r\n");
+        if ( first != std::string::npos && str[first] == '{')
+        {
+            readJson(str, results);
+        } else
+        {
+            std::istringstream is(str);
+            readCsv(is, results);
+        }
+        return true;
+    }
+
+    size_t compare(std::ostream &os, const std::vector<Result> &base, const std::vector<Result> &current,
+                   double threshold)
+    {
+        typedef std::map<std::string, const Result *> ResultMap;
+        auto key = [](const Result &r)
+        {
+            std::ostringstream k;
+            k << r.suite << "/" << r.name << "/" << r.dist << "/" << std::setw(12) << std::setfill('0') << r.size;
+            return k.str();
+        };
+
+        ResultMap base_map;
+        for (const Result &r : base) base_map[key(r)] = &r;
+
+        size_t regressions = 0;
+        size_t matched = 0;
+        for (const Result &r : current)
+        {
+            ResultMap::const_iterator it = base_map.find(key(r));
+            if ( it == base_map.end() || it->second->median_ns <= 0) continue;
+
+            matched++;
+            double change = (r.median_ns / it->second->median_ns - 1) * 100;
+            const char *verdict = "";
+            if ( change > threshold)
+            {
+                verdict = "  SLOWER";
+                regressions++;
+            } else if ( change < -threshold)
+            {
+                verdict = "  faster";
+            }
+
+            std::ostringstream line;
+            line << std::left << std::setw(9) << r.suite << std::setw(28) << r.name << std::setw(11) << r.dist
+                 << std::right << std::setw(9) << r.size << std::fixed << std::setprecision(2)
+                 << std::setw(14) << it->second->median_ns / 1000 << " us ->"
+                 << std::setw(12) << r.median_ns / 1000 << " us"
+                 << std::showpos << std::setw(10) << change << "%" << std::noshowpos << verdict;
+            os << line.str() << "\n";
+        }
+        os << matched << " points compared, " << regressions << " slower by more than " << threshold << "%\n";
+        return regressions;
+    }
+
+    /** Median time of the point or a negative value if it was not measured */
+    static double medianOf(const std::vector<Result> &results, const std::string &name, size_t size)
+    {
+        for (const Result &r : results)
+        {
+            if ( r.suite == "dispatch" && r.name == name && r.dist == "random" && r.size == size) return r.median_ns;
+        }
+        return -1;
+    }
+
+    void reportDispatchThresholds(std::ostream &os, const std::vector<Result> &results)
+    {
+        std::vector<size_t> sizes;
+        for (const Result &r : results)
+        {
+            if ( r.suite == "dispatch" && r.dist == "random") sizes.push_back(r.size);
+        }
+        if ( sizes.empty()) return;
+
+        std::sort(sizes.begin(), sizes.end());
+        sizes.erase( std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+        // Insertion sort is worth it up to the last size where it beats merge sort,
+        // radix sort from the first size where it beats merge sort
+        size_t insertion_max = 0;
+        size_t radix_min = 0;
+        for (size_t size : sizes)
+        {
+            double merge = medianOf(results, "merge", size);
+            double insertion = medianOf(results, "insertion", size);
+            double radix = medianOf(results, "radix", size);
+            if ( merge < 0) continue;
+
+            if ( insertion >= 0 && insertion <= merge) insertion_max = size;
+            if ( radix >= 0 && radix < merge && radix_min == 0) radix_min = size;
+        }
+
+        const Alg::SortThresholds &current = Alg::sortThresholds();
+        os << "Alg::sort thresholds (random input)  measured / current\n";
+        os << "  insertion_max: " << insertion_max << " / " << current.insertion_max << "\n";
+        os << "  radix_min:     " << radix_min << " / " << current.radix_min << "\n";
+    }
+
+} /* namespace Bench */
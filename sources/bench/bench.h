@@ -0,0 +1,150 @@
+/**
+ * @file: bench/bench.h
+ * Interface of the benchmark harness for the algorithms library
+ * @defgroup Bench Benchmarks
+ * @brief Timing of every library algorithm over configurable sizes and input distributions
+ */
+/*
+ * Algorithms library
+ * Copyright (C) 2015  Boris Shurygin
+ */
+#pragma once
+
+#include "../algorithms/alg_iface.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+namespace Bench
+{
+    using namespace Utils;
+
+    /**
+     * Input distributions
+     * @ingroup Bench
+     */
+    enum Distribution
+    {
+        Random,    /**< Uniform random values                    */
+        Sorted,    /**< Ascending values                         */
+        Reversed,  /**< Descending values                        */
+        FewUnique, /**< Random values out of 16 distinct ones    */
+        OrganPipe, /**< Ascending first half, descending second  */
+        NumDistributions
+    };
+
+    const char *distributionName(Distribution dist);      /**< Name used in the options and in the output */
+    bool parseDistribution(const std::string &name, Distribution *dist);
+
+    /**
+     * Input data of one (distribution, size) point, generated once and shared by all cases
+     * @ingroup Bench
+     */
+    struct Dataset
+    {
+        Distribution dist;
+        size_t size;
+        std::vector<UInt32> values;  /**< Input in the given distribution             */
+        std::vector<UInt32> sorted;  /**< Sorted copy of the input (search tables)     */
+        std::vector<UInt32> queries; /**< Search queries: hits and misses of the table */
+
+        Dataset(Distribution dist, size_t size, UInt64 seed, size_t num_queries);
+    };
+
+    /**
+     * Prepared benchmark action. reset() restores the input (not timed), run() does the timed work
+     * on 'batch' independent copies of the input
+     * @ingroup Bench
+     */
+    struct Runner
+    {
+        std::function<void()> reset;
+        std::function<void()> run;
+    };
+
+    /**
+     * Benchmark case: one algorithm of one suite
+     * @ingroup Bench
+     */
+    struct Case
+    {
+        std::string suite;         /**< Suite name: sort, search, heap, uf, graph etc.            */
+        std::string name;          /**< Algorithm name                                           */
+        std::vector<size_t> sizes; /**< Sizes used when none are given in the options             */
+        size_t max_size;           /**< Bigger inputs are skipped (quadratic algorithms)          */
+        bool per_query;            /**< Work is counted in queries rather than in elements        */
+
+        /** Prepare the runner for the dataset and the batch size: copy the input, build the index etc. */
+        std::function<Runner(const Dataset &, size_t)> prepare;
+    };
+
+    /** All the registered cases */
+    std::vector<Case> &cases();
+
+    /** Register the cases of all the library algorithms */
+    void registerCases();
+
+    /**
+     * Harness settings
+     * @ingroup Bench
+     */
+    struct Config
+    {
+        std::vector<std::string> suites;       /**< Suites to run, all if empty                      */
+        std::vector<std::string> filters;      /**< Substrings of case names to run, all if empty    */
+        std::vector<size_t> sizes;             /**< Input sizes, the defaults of each case if empty  */
+        std::vector<Distribution> dists;       /**< Input distributions                              */
+        unsigned warmup;                       /**< Untimed runs before the measurement              */
+        unsigned reps;                         /**< Timed samples per point                          */
+        size_t num_queries;                    /**< Queries per search sample                        */
+        size_t min_batch_work;                 /**< Minimum elements per sample, small inputs batch  */
+        UInt64 seed;                           /**< Seed of the input generator                      */
+
+        Config();
+    };
+
+    /**
+     * Result of one (case, distribution, size) point
+     * @ingroup Bench
+     */
+    struct Result
+    {
+        std::string suite;
+        std::string name;
+        std::string dist;
+        size_t size;
+        unsigned reps;
+        size_t batch;      /**< Runs of the algorithm per sample                     */
+        double work;       /**< Elements or queries processed by one run             */
+        double min_ns;     /**< Time statistics of one run, in nanoseconds           */
+        double median_ns;
+        double p90_ns;
+        double p99_ns;
+        double mean_ns;
+
+        double nsPerOp() const { return work > 0 ? median_ns / work : median_ns; }
+    };
+
+    /** Run the selected cases, 'progress' receives a line per finished point */
+    std::vector<Result> run(const Config &config, std::ostream *progress);
+
+    void writeJson(std::ostream &os, const std::vector<Result> &results, const Config &config);
+    void writeCsv(std::ostream &os, const std::vector<Result> &results);
+    void writeTable(std::ostream &os, const std::vector<Result> &results);
+
+    /** Read results written by writeJson or writeCsv, returns false if the file cannot be read */
+    bool readResults(const std::string &file_name, std::vector<Result> *results);
+
+    /**
+     * Print the median change of every point present in both result sets,
+     * returns the number of points that got slower by more than 'threshold' percent
+     */
+    size_t compare(std::ostream &os, const std::vector<Result> &base, const std::vector<Result> &current,
+                   double threshold);
+
+    /** Derive the Alg::sort dispatch thresholds from the 'dispatch' suite results and print them */
+    void reportDispatchThresholds(std::ostream &os, const std::vector<Result> &results);
+
+} /* namespace Bench */
@@ -0,0 +1,789 @@
+/**
+ * @file: bench/bench_cases.cpp
+ * Benchmark cases of the library algorithms
+ */
+/*
+ * Algorithms library
+ * Copyright (C) 2015  Boris Shurygin
+ */
+#include "bench.h"
+
+#include <memory>
+#include <queue>
+#include <cmath>
+
+namespace Bench
+{
+    using namespace Alg;
+
+    typedef std::vector<UInt32> Values;
+
+    /** Results of the searches are accumulated here so that the compiler cannot drop them */
+    static UInt64 sink = 0;
+
+    /** Sizes the quadratic sorts are limited to */
+    static const size_t quadratic_max = 1 << 14;
+
+    static const size_t no_limit = ~size_t(0);
+
+    static std::vector<size_t> sortSizes()     { return { 1000, 10000, 100000, 1000000 }; }
+    static std::vector<size_t> searchSizes()   { return { 1000, 100000, 1000000, 10000000 }; }
+    static std::vector<size_t> dispatchSizes() { return { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 1024 }; }
+    static std::vector<size_t> smallSizes()    { return { 4, 8, 16, 32 }; }
+    static std::vector<size_t> graphSizes()    { return { 1 << 10, 1 << 14, 1 << 17, 1 << 20 }; }
+
+    /**
+     * Case that works on copies of the input values: sorts, shuffles. Each run gets a fresh copy,
+     * the copying is done by reset() and is not timed
+     */
+    template <class Algorithm>
+    static Case inPlaceCase(const char *suite, const char *name, std::vector<size_t> sizes, size_t max_size,
+                            Algorithm algorithm)
+    {
+        Case c;
+        c.suite = suite;
+        c.name = name;
+        c.sizes = sizes;
+        c.max_size = max_size;
+        c.per_query = false;
+        c.prepare = [algorithm](const Dataset &data, size_t batch)
+        {
+            std::shared_ptr<std::vector<Values> > copies = std::make_shared<std::vector<Values> >(batch);
+            const Values *input = &data.values;
+
+            Runner runner;
+            runner.reset = [copies, input]()
+            {
+                for (Values &copy : *copies) copy = *input;
+            };
+            runner.run = [copies, algorithm]()
+            {
+                for (Values &copy : *copies) algorithm(copy);
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    /**
+     * Case that runs all the queries of the dataset against a structure built over the sorted values.
+     * 'build' does the untimed preparation and returns the function that answers all the queries
+     */
+    template <class Build>
+    static Case queryCase(const char *suite, const char *name, Build build)
+    {
+        Case c;
+        c.suite = suite;
+        c.name = name;
+        c.sizes = searchSizes();
+        c.max_size = no_limit;
+        c.per_query = true;
+        c.prepare = [build](const Dataset &data, size_t batch)
+        {
+            std::function<UInt64()> queries = build(data);
+
+            Runner runner;
+            runner.reset = [](){};
+            runner.run = [queries, batch]()
+            {
+                for (size_t i = 0; i < batch; i++) sink += queries();
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    /**
+     * Case that runs a whole workload on a fresh structure each time: priority queues, union-find
+     */
+    template <class Workload>
+    static Case workloadCase(const char *suite, const char *name, size_t max_size, Workload workload)
+    {
+        Case c;
+        c.suite = suite;
+        c.name = name;
+        c.sizes = sortSizes();
+        c.max_size = max_size;
+        c.per_query = false;
+        c.prepare = [workload](const Dataset &data, size_t batch)
+        {
+            const Dataset *input = &data;
+
+            Runner runner;
+            runner.reset = [](){};
+            runner.run = [workload, input, batch]()
+            {
+                for (size_t i = 0; i < batch; i++) sink += workload(*input);
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    static void registerSortCases(std::vector<Case> &all)
+    {
+        all.push_back( inPlaceCase("sort", "bubble", sortSizes(), quadratic_max,
+                                   [](Values &v){ bubbleSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "selection", sortSizes(), quadratic_max,
+                                   [](Values &v){ selectionSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "insertion", sortSizes(), quadratic_max,
+                                   [](Values &v){ insertionSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "shell", sortSizes(), quadratic_max,
+                                   [](Values &v){ shellSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "merge", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "merge_bu", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSortBU(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "merge_buffered_0", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSortBuffered(v.begin(), v.end(), 0); }));
+        all.push_back( inPlaceCase("sort", "merge_buffered_sqrt", sortSizes(), no_limit, [](Values &v)
+        {
+            mergeSortBuffered(v.begin(), v.end(), static_cast<size_t>( std::sqrt( static_cast<double>(v.size()))));
+        }));
+        all.push_back( inPlaceCase("sort", "merge_buffered_half", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSortBuffered(v.begin(), v.end(), v.size() / 2); }));
+        all.push_back( inPlaceCase("sort", "alg_sort", sortSizes(), no_limit,
+                                   [](Values &v){ Alg::sort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "alg_sort_stable", sortSizes(), no_limit,
+                                   [](Values &v){ Alg::sort<Stable>(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "merge_sort_by", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSortBy(v.begin(), v.end(), [](UInt32 x){ return x >> 8; }); }));
+        all.push_back( inPlaceCase("sort", "radix_sort_by", sortSizes(), no_limit,
+                                   [](Values &v){ radixSortBy(v.begin(), v.end(), [](UInt32 x){ return x >> 8; }); }));
+
+        // Same sorts with the scratch memory reused between the runs
+        std::shared_ptr<Workspace> ws = std::make_shared<Workspace>();
+        all.push_back( inPlaceCase("sort", "merge_ws", sortSizes(), no_limit,
+                                   [ws](Values &v){ mergeSort(v.begin(), v.end(), *ws); }));
+        all.push_back( inPlaceCase("sort", "alg_sort_ws", sortSizes(), no_limit,
+                                   [ws](Values &v){ Alg::sort(v.begin(), v.end(), *ws); }));
+        all.push_back( inPlaceCase("sort", "radix_sort_by_ws", sortSizes(), no_limit,
+                                   [ws](Values &v){ radixSortBy(v.begin(), v.end(), [](UInt32 x){ return x >> 8; }, *ws); }));
+
+        // Scratch memory on huge pages
+        std::shared_ptr<Workspace> huge_ws = std::make_shared<Workspace>( StorageOptions(TransparentHugePages));
+        all.push_back( inPlaceCase("sort", "merge_ws_huge", sortSizes(), no_limit,
+                                   [huge_ws](Values &v){ mergeSort(v.begin(), v.end(), *huge_ws); }));
+        all.push_back( inPlaceCase("sort", "radix_sort_by_ws_huge", sortSizes(), no_limit,
+                                   [huge_ws](Values &v){ radixSortBy(v.begin(), v.end(), [](UInt32 x){ return x >> 8; }, *huge_ws); }));
+
+        // Parallel policies on the shared thread pool, see --threads
+        all.push_back( inPlaceCase("sort", "merge_par", sortSizes(), no_limit,
+                                   [](Values &v){ mergeSort(execution::par, v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "alg_sort_par", sortSizes(), no_limit,
+                                   [](Values &v){ Alg::sort(execution::par, v.begin(), v.end()); }));
+
+        // First page of 100 elements out of a sorted set
+        all.push_back( inPlaceCase("sort", "incremental_page", sortSizes(), no_limit, [](Values &v)
+        {
+            auto sorter = incrementalSort(v.begin(), v.end());
+            for (size_t i = 0; i < 100 && !sorter.done(); i++) sink += sorter.next();
+        }));
+        all.push_back( inPlaceCase("sort", "std_partial_sort_page", sortSizes(), no_limit, [](Values &v)
+        {
+            std::partial_sort(v.begin(), v.begin() + std::min<size_t>(100, v.size()), v.end());
+        }));
+        all.push_back( inPlaceCase("sort", "std_sort", sortSizes(), no_limit,
+                                   [](Values &v){ std::sort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("sort", "std_stable_sort", sortSizes(), no_limit,
+                                   [](Values &v){ std::stable_sort(v.begin(), v.end()); }));
+    }
+
+    static void registerSearchCases(std::vector<Case> &all)
+    {
+        all.push_back( queryCase("search", "bin_search", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [table, queries]()
+            {
+                UInt64 found = 0;
+                for (UInt32 q : *queries) found += binSearch(q, table->begin(), table->end()) != table->end();
+                return found;
+            });
+        }));
+        all.push_back( queryCase("search", "lower_bound", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [table, queries]()
+            {
+                UInt64 sum = 0;
+                for (UInt32 q : *queries) sum += lowerBound(q, table->begin(), table->end()) - table->begin();
+                return sum;
+            });
+        }));
+        all.push_back( queryCase("search", "std_lower_bound", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [table, queries]()
+            {
+                UInt64 sum = 0;
+                for (UInt32 q : *queries) sum += std::lower_bound(table->begin(), table->end(), q) - table->begin();
+                return sum;
+            });
+        }));
+        all.push_back( queryCase("search", "lower_bound_batch", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            std::shared_ptr<std::vector<size_t> > results = std::make_shared<std::vector<size_t> >();
+            return std::function<UInt64()>( [table, queries, results]()
+            {
+                lowerBoundBatch(*queries, *table, *results);
+                return static_cast<UInt64>( results->back());
+            });
+        }));
+        all.push_back( queryCase("search", "lower_bound_batch_par", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            std::shared_ptr<std::vector<size_t> > results = std::make_shared<std::vector<size_t> >();
+            return std::function<UInt64()>( [table, queries, results]()
+            {
+                lowerBoundBatch(execution::par, *queries, *table, *results);
+                return static_cast<UInt64>( results->back());
+            });
+        }));
+        all.push_back( queryCase("search", "search_index", [](const Dataset &data)
+        {
+            std::shared_ptr<StaticSearchIndex<UInt32> > index =
+                std::make_shared<StaticSearchIndex<UInt32> >(data.sorted.begin(), data.sorted.end());
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [index, queries]()
+            {
+                UInt64 sum = 0;
+                for (UInt32 q : *queries) sum += index->lowerBound(q);
+                return sum;
+            });
+        }));
+        all.push_back( queryCase("search", "interpolation", [](const Dataset &data)
+        {
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [table, queries]()
+            {
+                UInt64 sum = 0;
+                for (UInt32 q : *queries)
+                {
+                    sum += interpolationLowerBound(q, table->begin(), table->end()) - table->begin();
+                }
+                return sum;
+            });
+        }));
+        all.push_back( queryCase("search", "learned_index", [](const Dataset &data)
+        {
+            std::shared_ptr<LearnedIndex<UInt32> > index = std::make_shared<LearnedIndex<UInt32> >(data.sorted);
+            const Values *table = &data.sorted;
+            const Values *queries = &data.queries;
+            return std::function<UInt64()>( [index, table, queries]()
+            {
+                UInt64 sum = 0;
+                for (UInt32 q : *queries) sum += index->lowerBound(q) - table->begin();
+                return sum;
+            });
+        }));
+    }
+
+    static void registerShuffleCases(std::vector<Case> &all)
+    {
+        all.push_back( inPlaceCase("shuffle", "shuffle", sortSizes(), no_limit, [](Values &v)
+        {
+            static Xoshiro256 rng(1);
+            Alg::shuffle(v.begin(), v.end(), rng);
+        }));
+        all.push_back( inPlaceCase("shuffle", "merge_shuffle", sortSizes(), no_limit, [](Values &v)
+        {
+            static Xoshiro256 rng(1);
+            mergeShuffle(v.begin(), v.end(), rng);
+        }));
+        all.push_back( inPlaceCase("shuffle", "sample_10pct", sortSizes(), no_limit, [](Values &v)
+        {
+            static Xoshiro256 rng(1);
+            sample(v.begin(), v.end(), v.size() / 10, rng);
+        }));
+        all.push_back( inPlaceCase("shuffle", "shuffle_par", sortSizes(), no_limit, [](Values &v)
+        {
+            static Xoshiro256 rng(1);
+            Alg::shuffle(execution::par, v.begin(), v.end(), rng);
+        }));
+        all.push_back( inPlaceCase("shuffle", "std_shuffle", sortSizes(), no_limit, [](Values &v)
+        {
+            static Xoshiro256 rng(1);
+            std::shuffle(v.begin(), v.end(), rng);
+        }));
+    }
+
+    static void registerHeapCases(std::vector<Case> &all)
+    {
+        // Push all the values, then pop them all
+        all.push_back( workloadCase("heap", "priority_queue", no_limit, [](const Dataset &data)
+        {
+            PriorityQueue<UInt32> queue;
+            for (UInt32 val : data.values) queue.push(val);
+
+            UInt64 sum = 0;
+            while ( !queue.empty())
+            {
+                sum += queue.top();
+                queue.pop();
+            }
+            return sum;
+        }));
+        // 1 MiB budget: the bigger inputs are spilled to temporary files
+        all.push_back( workloadCase("heap", "external_queue", no_limit, [](const Dataset &data)
+        {
+            ExternalPriorityQueue<UInt32> queue(1024 * 1024);
+            for (UInt32 val : data.values) queue.push(val);
+
+            UInt64 sum = 0;
+            while ( !queue.empty())
+            {
+                sum += queue.top();
+                queue.pop();
+            }
+            return sum;
+        }));
+        all.push_back( workloadCase("heap", "priority_queue_huge", no_limit, [](const Dataset &data)
+        {
+            PriorityQueue<UInt32, LargeAllocator<UInt32> > queue( (LargeAllocator<UInt32>( StorageOptions(TransparentHugePages))));
+            for (UInt32 val : data.values) queue.push(val);
+
+            UInt64 sum = 0;
+            while ( !queue.empty())
+            {
+                sum += queue.top();
+                queue.pop();
+            }
+            return sum;
+        }));
+        all.push_back( workloadCase("heap", "std_priority_queue", no_limit, [](const Dataset &data)
+        {
+            std::priority_queue<UInt32> queue;
+            for (UInt32 val : data.values) queue.push(val);
+
+            UInt64 sum = 0;
+            while ( !queue.empty())
+            {
+                sum += queue.top();
+                queue.pop();
+            }
+            return sum;
+        }));
+    }
+
+    /** Union-find workload: every node is united with a node picked by the input, then the queries are checked */
+    template <class UFType>
+    static UInt64 ufRun(const Dataset &data, UFType &uf)
+    {
+        UInt32 size = static_cast<UInt32>(data.size);
+        for (UInt32 i = 0; i < size; i += 2)
+        {
+            uf.unite(i, data.values[i] % size);
+        }
+
+        UInt64 connected = 0;
+        for (UInt32 i = 1; i < size; i += 2)
+        {
+            connected += uf.areConnected(i - 1, data.values[i] % size);
+        }
+        return connected;
+    }
+
+    template <class UFImpl>
+    static UInt64 ufWorkload(const Dataset &data)
+    {
+        UF<UFImpl> uf( static_cast<UInt32>(data.size));
+        return ufRun(data, uf);
+    }
+
+    /** Same workload with the node arrays on the given pages and placement */
+    template <class UFImpl, StoragePages pages, StoragePlacement placement>
+    static UInt64 ufStorageWorkload(const Dataset &data)
+    {
+        UF<UFImpl> uf( static_cast<UInt32>(data.size), StorageOptions(pages, placement));
+        return ufRun(data, uf);
+    }
+
+    /** Same workload with the batch operations under the execution policy */
+    template <class UFImpl, class ExecutionPolicy>
+    static UInt64 ufBatchWorkload(const Dataset &data)
+    {
+        UInt32 size = static_cast<UInt32>(data.size);
+        UFPairs edges, queries;
+        for (UInt32 i = 0; i < size; i += 2) edges.push_back( std::make_pair(i, data.values[i] % size));
+        for (UInt32 i = 1; i < size; i += 2) queries.push_back( std::make_pair(i - 1, data.values[i] % size));
+
+        UF<UFImpl> uf(size);
+        uniteBatch(ExecutionPolicy(), uf, edges);
+
+        std::vector<UInt8> results;
+        areConnectedBatch(ExecutionPolicy(), uf, queries, results);
+        return std::count(results.begin(), results.end(), 1);
+    }
+
+    static void registerUFCases(std::vector<Case> &all)
+    {
+        all.push_back( workloadCase("uf", "plain", quadratic_max, &ufWorkload<PlainUF>));
+        all.push_back( workloadCase("uf", "tree", 1 << 16, &ufWorkload<TreeUF<NotWeighted, NoCompression> >));
+        all.push_back( workloadCase("uf", "tree_weighted", no_limit, &ufWorkload<TreeUF<Weighted, NoCompression> >));
+        all.push_back( workloadCase("uf", "tree_compressed", no_limit,
+                                    &ufWorkload<TreeUF<NotWeighted, PathCompression> >));
+        all.push_back( workloadCase("uf", "tree_weighted_compressed", no_limit,
+                                    &ufWorkload<TreeUF<Weighted, PathCompression> >));
+        all.push_back( workloadCase("uf", "tree_huge", no_limit,
+                                    &ufStorageWorkload<TreeUF<Weighted, PathCompression>, TransparentHugePages,
+                                                       LocalPlacement>));
+        all.push_back( workloadCase("uf", "tree_huge_interleaved", no_limit,
+                                    &ufStorageWorkload<TreeUF<Weighted, PathCompression>, TransparentHugePages,
+                                                       InterleavedPlacement>));
+        all.push_back( workloadCase("uf", "tree_huge_spread", no_limit,
+                                    &ufStorageWorkload<TreeUF<Weighted, PathCompression>, TransparentHugePages,
+                                                       SpreadPlacement>));
+        all.push_back( workloadCase("uf", "tree_batch", no_limit,
+                                    &ufBatchWorkload<TreeUF<Weighted, PathCompression>, execution::SequencedPolicy>));
+        all.push_back( workloadCase("uf", "tree_batch_par", no_limit,
+                                    &ufBatchWorkload<TreeUF<Weighted, PathCompression>, execution::ParallelPolicy>));
+    }
+
+    /** Engines of Alg::sort around the dispatch thresholds, see reportDispatchThresholds */
+    static void registerDispatchCases(std::vector<Case> &all)
+    {
+        all.push_back( inPlaceCase("dispatch", "insertion", dispatchSizes(), no_limit, [](Values &v)
+        {
+            std::less<UInt32> comp;
+            Merge::insertionSortRun(v.begin(), v.end(), comp);
+        }));
+        all.push_back( inPlaceCase("dispatch", "merge", dispatchSizes(), no_limit,
+                                   [](Values &v){ mergeSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("dispatch", "natural_merge", dispatchSizes(), no_limit, [](Values &v)
+        {
+            std::less<UInt32> comp;
+            std::vector<Values::iterator> bounds;
+            Values buf;
+            SortDispatch::naturalMergeSort(v.begin(), v.end(), NotStable, comp, bounds, buf);
+        }));
+        all.push_back( inPlaceCase("dispatch", "radix", dispatchSizes(), no_limit, [](Values &v)
+        {
+            SortDispatch::radixSortValues(v.begin(), v.end(),
+                                          std::integral_constant<SortDispatch::RadixOrder, SortDispatch::Ascending>());
+        }));
+        all.push_back( inPlaceCase("dispatch", "alg_sort", dispatchSizes(), no_limit,
+                                   [](Values &v){ Alg::sort(v.begin(), v.end()); }));
+
+        std::shared_ptr<Workspace> ws = std::make_shared<Workspace>();
+        all.push_back( inPlaceCase("dispatch", "alg_sort_ws", dispatchSizes(), no_limit,
+                                   [ws](Values &v){ Alg::sort(v.begin(), v.end(), *ws); }));
+    }
+
+    /** Network of the size of the values, the size must be one of smallSizes() */
+    static void staticSortValues(Values &v)
+    {
+        switch ( v.size())
+        {
+            case 4:  staticSort<4>(v.begin()); break;
+            case 8:  staticSort<8>(v.begin()); break;
+            case 16: staticSort<16>(v.begin()); break;
+            case 32: staticSort<32>(v.begin()); break;
+            default: Alg::sort(v.begin(), v.end());
+        }
+    }
+
+    /** Sorting networks against the insertion sort on tiny arrays */
+    static void registerSmallCases(std::vector<Case> &all)
+    {
+        all.push_back( inPlaceCase("small", "static_sort", smallSizes(), no_limit, staticSortValues));
+        all.push_back( inPlaceCase("small", "insertion", smallSizes(), no_limit,
+                                   [](Values &v){ insertionSort(v.begin(), v.end()); }));
+        all.push_back( inPlaceCase("small", "std_sort", smallSizes(), no_limit,
+                                   [](Values &v){ std::sort(v.begin(), v.end()); }));
+    }
+
+    typedef std::vector<std::string> Strings;
+
+    /**
+     * Case that sorts copies of URL-like strings made of the input values: a few hosts, long shared prefixes
+     * and duplicates. The copying is done by reset() and is not timed
+     */
+    template <class Algorithm>
+    static Case stringCase(const char *name, Algorithm algorithm)
+    {
+        Case c;
+        c.suite = "string";
+        c.name = name;
+        c.sizes = sortSizes();
+        c.max_size = no_limit;
+        c.per_query = false;
+        c.prepare = [algorithm](const Dataset &data, size_t batch)
+        {
+            static const char *hosts[] = { "https://www.example.com/", "https://static.example.com/assets/",
+                                           "https://api.example.org/v2/users/" };
+            std::shared_ptr<Strings> input = std::make_shared<Strings>();
+            for (UInt32 val : data.values)
+            {
+                input->push_back( std::string(hosts[val % 3]) + std::to_string(val % 1000) + "/item/"
+                                  + std::to_string(val));
+            }
+            std::shared_ptr<std::vector<Strings> > copies = std::make_shared<std::vector<Strings> >(batch);
+
+            Runner runner;
+            runner.reset = [copies, input]()
+            {
+                for (Strings &copy : *copies) copy = *input;
+            };
+            runner.run = [copies, algorithm]()
+            {
+                for (Strings &copy : *copies) algorithm(copy);
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    static void registerStringCases(std::vector<Case> &all)
+    {
+        all.push_back( stringCase("multikey_quick", [](Strings &v){ multikeyQuickSort(v.begin(), v.end()); }));
+        all.push_back( stringCase("radix", [](Strings &v){ stringRadixSort(v.begin(), v.end()); }));
+        all.push_back( stringCase("lcp_merge", [](Strings &v)
+        {
+            std::vector<size_t> lcp;
+            lcpMergeSort(v.begin(), v.end(), lcp);
+        }));
+        all.push_back( stringCase("merge", [](Strings &v){ mergeSort(v.begin(), v.end()); }));
+        all.push_back( stringCase("std_sort", [](Strings &v){ std::sort(v.begin(), v.end()); }));
+    }
+
+    /** Input of the graph cases: R-MAT graph of 8 edges per vertex, the number of vertices is a power of two */
+    struct GraphInput
+    {
+        UInt32 num_vertices;
+        Graph<>::EdgeList edges;
+        Graph<> graph;
+        UInt32 source;
+    };
+
+    /**
+     * Case that runs an algorithm on an R-MAT graph generated for the size. The graph does not depend
+     * on the distribution of the dataset
+     */
+    template <class Algorithm>
+    static Case graphCase(const char *name, Algorithm algorithm)
+    {
+        Case c;
+        c.suite = "graph";
+        c.name = name;
+        c.sizes = graphSizes();
+        c.max_size = no_limit;
+        c.per_query = false;
+        c.prepare = [algorithm](const Dataset &data, size_t batch)
+        {
+            UInt32 scale = 0;
+            while ( (size_t(1) << scale) < data.size) scale++;
+
+            std::shared_ptr<GraphInput> input = std::make_shared<GraphInput>();
+            Xoshiro256 rng(scale);
+            input->num_vertices = UInt32(1) << scale;
+            rmatEdges<UInt32>(scale, 8 * size_t(input->num_vertices), 255, rng, input->edges);
+            input->graph.build(input->num_vertices, input->edges);
+            input->source = input->edges.front().from;
+
+            Runner runner;
+            runner.reset = [](){};
+            runner.run = [algorithm, input, batch]()
+            {
+                for (size_t i = 0; i < batch; i++) sink += algorithm(*input);
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    /** Top-down only BFS with a plain queue, the baseline of the direction-optimizing one */
+    static UInt64 queueBfs(const GraphInput &input)
+    {
+        const Graph<> &graph = input.graph;
+        std::vector<UInt32> parent(graph.numVertices(), no_vertex);
+        std::vector<UInt32> queue(1, input.source);
+        parent[input.source] = input.source;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            UInt32 u = queue[head];
+            for (UInt32 i = 0; i < graph.degree(u); i++)
+            {
+                UInt32 v = graph.targets(u)[i];
+                if ( parent[v] != no_vertex) continue;
+
+                parent[v] = u;
+                queue.push_back(v);
+            }
+        }
+        return queue.size();
+    }
+
+    static void registerGraphCases(std::vector<Case> &all)
+    {
+        all.push_back( graphCase("build", [](const GraphInput &input)
+        {
+            Graph<> graph;
+            graph.build(input.num_vertices, input.edges);
+            return UInt64(graph.numArcs());
+        }));
+        all.push_back( graphCase("build_par", [](const GraphInput &input)
+        {
+            Graph<> graph;
+            graph.build(execution::par, input.num_vertices, input.edges);
+            return UInt64(graph.numArcs());
+        }));
+        all.push_back( graphCase("kruskal", [](const GraphInput &input)
+        {
+            Graph<>::EdgeList forest;
+            kruskalMST(input.graph, forest);
+            return UInt64(forest.size());
+        }));
+        all.push_back( graphCase("prim", [](const GraphInput &input)
+        {
+            Graph<>::EdgeList forest;
+            primMST(input.graph, forest);
+            return UInt64(forest.size());
+        }));
+        all.push_back( graphCase("dijkstra", [](const GraphInput &input)
+        {
+            std::vector<UInt32> dist, parent;
+            dijkstra(input.graph, input.source, dist, parent);
+            return UInt64( std::count(parent.begin(), parent.end(), no_vertex));
+        }));
+        all.push_back( graphCase("bfs", [](const GraphInput &input)
+        {
+            std::vector<UInt32> parent;
+            bfs(input.graph, input.source, parent);
+            return UInt64( std::count(parent.begin(), parent.end(), no_vertex));
+        }));
+        all.push_back( graphCase("bfs_queue", &queueBfs));
+    }
+
+    /** Posting lists made of the positions of the values with some bits set, the output has room for any result */
+    struct SetInput
+    {
+        Values half;    // Every second position
+        Values other;   // Every second position, independent of 'half'
+        Values third;   // Every second position, independent of both
+        Values rare;    // Every 128th position
+        Values out;
+    };
+
+    /**
+     * Case that runs a set operation on the posting lists built for the dataset
+     */
+    template <class Algorithm>
+    static Case setCase(const char *name, Algorithm algorithm)
+    {
+        Case c;
+        c.suite = "set";
+        c.name = name;
+        c.sizes = sortSizes();
+        c.max_size = no_limit;
+        c.per_query = false;
+        c.prepare = [algorithm](const Dataset &data, size_t batch)
+        {
+            std::shared_ptr<SetInput> input = std::make_shared<SetInput>();
+            for (UInt32 i = 0; i < data.size; i++)
+            {
+                UInt32 val = data.values[i];
+                if ( val & 1) input->half.push_back(i);
+                if ( val & 0x100) input->other.push_back(i);
+                if ( val & 0x10000) input->third.push_back(i);
+                if ( (val >> 24) % 128 == 0) input->rare.push_back(i);
+            }
+            input->out.resize(data.size);
+
+            Runner runner;
+            runner.reset = [](){};
+            runner.run = [algorithm, input, batch]()
+            {
+                for (size_t i = 0; i < batch; i++) sink += algorithm(*input);
+            };
+            return runner;
+        };
+        return c;
+    }
+
+    static void registerSetCases(std::vector<Case> &all)
+    {
+        typedef Values::iterator Iterator;
+        auto scalar_less = [](UInt32 a, UInt32 b) { return a < b; };
+
+        all.push_back( setCase("intersect", [](SetInput &in)
+        {
+            return UInt64( setIntersect(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(), in.out.begin())
+                           - in.out.begin());
+        }));
+        all.push_back( setCase("intersect_scalar", [scalar_less](SetInput &in)
+        {
+            return UInt64( setIntersect(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(), in.out.begin(),
+                                        scalar_less) - in.out.begin());
+        }));
+        all.push_back( setCase("std_set_intersection", [](SetInput &in)
+        {
+            return UInt64( std::set_intersection(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(),
+                                                 in.out.begin()) - in.out.begin());
+        }));
+        all.push_back( setCase("intersect_skewed", [](SetInput &in)
+        {
+            return UInt64( setIntersect(in.rare.begin(), in.rare.end(), in.half.begin(), in.half.end(), in.out.begin())
+                           - in.out.begin());
+        }));
+        all.push_back( setCase("std_set_intersection_skewed", [](SetInput &in)
+        {
+            return UInt64( std::set_intersection(in.rare.begin(), in.rare.end(), in.half.begin(), in.half.end(),
+                                                 in.out.begin()) - in.out.begin());
+        }));
+        all.push_back( setCase("intersect_3way", [](SetInput &in)
+        {
+            std::vector<std::pair<Iterator, Iterator> > sets = { std::make_pair(in.half.begin(), in.half.end()),
+                                                                 std::make_pair(in.other.begin(), in.other.end()),
+                                                                 std::make_pair(in.third.begin(), in.third.end()) };
+            Values res;
+            setIntersect(sets, res);
+            return UInt64(res.size());
+        }));
+        all.push_back( setCase("union", [](SetInput &in)
+        {
+            return UInt64( setUnion(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(), in.out.begin())
+                           - in.out.begin());
+        }));
+        all.push_back( setCase("std_set_union", [](SetInput &in)
+        {
+            return UInt64( std::set_union(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(),
+                                          in.out.begin()) - in.out.begin());
+        }));
+        all.push_back( setCase("difference", [](SetInput &in)
+        {
+            return UInt64( setDifference(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(), in.out.begin())
+                           - in.out.begin());
+        }));
+        all.push_back( setCase("std_set_difference", [](SetInput &in)
+        {
+            return UInt64( std::set_difference(in.half.begin(), in.half.end(), in.other.begin(), in.other.end(),
+                                               in.out.begin()) - in.out.begin());
+        }));
+    }
+
+    void registerCases()
+    {
+        std::vector<Case> &all = cases();
+        if ( !all.empty()) return;
+
+        registerSortCases(all);
+        registerSearchCases(all);
+        registerShuffleCases(all);
+        registerHeapCases(all);
+        registerUFCases(all);
+        registerDispatchCases(all);
+        registerSmallCases(all);
+        registerGraphCases(all);
+        registerStringCases(all);
+        registerSetCases(all);
+    }
+
+} /* namespace Bench */
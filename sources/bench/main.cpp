@@ -0,0 +1,159 @@
+/**
+ * @file: bench/main.cpp
+ * Entry point of the benchmark suite of the algorithms library
+ *
+ * Usage:
+ *   bench [options]                  run the benchmarks
+ *   bench --compare base.json new.json [--threshold=5]
+ *                                    compare two result files (JSON or CSV), exits with 1 on regressions
+ * Options:
+ *   --suite=sort,search,...   suites to run: sort, search, shuffle, heap, uf, dispatch, small, graph, string, set (all by default)
+ *   --filter=merge,radix      run only the cases whose names contain one of the substrings
+ *   --sizes=1000,1000000      input sizes (each case has its defaults)
+ *   --dist=random,sorted      input distributions: random, sorted, reversed, few_unique, organ_pipe
+ *   --reps=N --warmup=N       timed samples and untimed warmup runs per point
+ *   --queries=N               queries per search run
+ *   --seed=N                  seed of the input generator
+ *   --threads=N               threads of the pool used by the parallel cases (*_par)
+ *   --format=table|json|csv   output format, --out=FILE writes the output to the file
+ *   --list                    list the cases
+ */
+/*
+ * Algorithms library
+ * Copyright (C) 2015  Boris Shurygin
+ */
+#include "bench.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+using namespace Bench;
+
+/** Split comma separated list */
+static std::vector<std::string> splitList(const std::string &str)
+{
+    std::vector<std::string> items;
+    std::istringstream is(str);
+    std::string item;
+    while ( std::getline(is, item, ','))
+    {
+        if ( !item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static int usage(const char *error)
+{
+    std::cerr << "bench: " << error << "\n"
+              << "usage: bench [--suite=LIST] [--filter=LIST] [--sizes=LIST] [--dist=LIST] [--reps=N] [--warmup=N]\n"
+              << "             [--queries=N] [--seed=N] [--threads=N] [--format=table|json|csv] [--out=FILE] [--list]\n"
+              << "       bench --compare BASE NEW [--threshold=PERCENT]\n";
+    return 2;
+}
+
+/**
+ * The entry point of the benchmarks
+ */
+int main(int argc, char **argv)
+{
+    Utils::MemMgr::init();
+
+    registerCases();
+
+    Config config;
+    std::string format = "table";
+    std::string out_name;
+    std::vector<std::string> compare_files;
+    bool compare_mode = false;
+    bool list = false;
+    double threshold = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string key = arg;
+        std::string val;
+        size_t eq = arg.find('=');
+        if ( eq != std::string::npos)
+        {
+            key = arg.substr(0, eq);
+            val = arg.substr(eq + 1);
+        }
+
+        if ( key == "--suite") config.suites = splitList(val);
+        else if ( key == "--filter") config.filters = splitList(val);
+        else if ( key == "--sizes")
+        {
+            config.sizes.clear();
+            for (const std::string &size : splitList(val)) config.sizes.push_back( std::strtoull(size.c_str(), nullptr, 10));
+        }
+        else if ( key == "--dist")
+        {
+            config.dists.clear();
+            for (const std::string &name : splitList(val))
+            {
+                Distribution dist;
+                if ( !parseDistribution(name, &dist)) return usage("unknown distribution");
+                config.dists.push_back(dist);
+            }
+        }
+        else if ( key == "--reps") config.reps = std::max(1, std::atoi(val.c_str()));
+        else if ( key == "--warmup") config.warmup = std::max(0, std::atoi(val.c_str()));
+        else if ( key == "--queries") config.num_queries = std::max(1ull, std::strtoull(val.c_str(), nullptr, 10));
+        else if ( key == "--seed") config.seed = std::strtoull(val.c_str(), nullptr, 10);
+        else if ( key == "--threads")
+        {
+            Alg::ThreadPool::Config pool_config;
+            pool_config.num_threads = std::max(1, std::atoi(val.c_str()));
+            Alg::ThreadPool::instance().configure(pool_config);
+        }
+        else if ( key == "--format") format = val;
+        else if ( key == "--out") out_name = val;
+        else if ( key == "--list") list = true;
+        else if ( key == "--compare") compare_mode = true;
+        else if ( key == "--threshold") threshold = std::atof(val.c_str());
+        else if ( compare_mode && arg[0] != '-') compare_files.push_back(arg);
+        else return usage("unknown option");
+    }
+
+    int res = 0;
+    if ( list)
+    {
+        for (const Case &c : cases()) std::cout << c.suite << " " << c.name << "\n";
+    } else if ( compare_mode)
+    {
+        std::vector<Result> base, current;
+        if ( compare_files.size() != 2) return usage("--compare needs two result files");
+        if ( !readResults(compare_files[0], &base) || !readResults(compare_files[1], &current) )
+        {
+            return usage("cannot read the result files");
+        }
+        res = compare(std::cout, base, current, threshold) > 0 ? 1 : 0;
+    } else
+    {
+        if ( format != "table" && format != "json" && format != "csv") return usage("unknown format");
+
+        // Progress and the threshold report go to the console unless it takes json or csv results
+        bool to_file = !out_name.empty();
+        bool console = to_file || format == "table";
+        std::vector<Result> results = run(config, console ? &std::cout : nullptr);
+
+        std::ofstream out_file;
+        if ( to_file)
+        {
+            out_file.open(out_name.c_str());
+            if ( !out_file) return usage("cannot open the output file");
+        }
+        std::ostream &os = to_file ? out_file : std::cout;
+        if ( format == "json") writeJson(os, results, config);
+        else if ( format == "csv") writeCsv(os, results);
+        else if ( to_file) writeTable(os, results);
+
+        if ( console) reportDispatchThresholds(std::cout, results);
+    }
+
+    Utils::MemMgr::deinit();
+    return res;
+}